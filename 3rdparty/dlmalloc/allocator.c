@@ -40,6 +40,7 @@ static uint8_t* _heap_start;
 static uint8_t* _heap_end;
 static uint8_t* _heap_next;
 static size_t _max_heap_size;
+static size_t _heap_high_water_mark;
 static int _lock = 0;
 void* dlmalloc_sbrk(ptrdiff_t increment)
 {
@@ -58,6 +59,10 @@ void* dlmalloc_sbrk(ptrdiff_t increment)
         {
             ptr = _heap_next;
             _heap_next += increment;
+
+            /* dlmalloc trims the heap with negative increments */
+            if ((size_t)(_heap_next - _heap_start) > _heap_high_water_mark)
+                _heap_high_water_mark = (size_t)(_heap_next - _heap_start);
         }
     }
     RELEASE_LOCK(&_lock);
@@ -65,6 +70,264 @@ void* dlmalloc_sbrk(ptrdiff_t increment)
     return ptr;
 }
 
+/*
+**==============================================================================
+**
+** Thread statistics
+**
+**     Each enclave thread counts its allocations and frees in a slot of
+**     _thread_stats, that it looks up by the address of its thread cache.
+**     That address is the same for every thread that runs on a given TCS, so
+**     the statistics of a TCS survive its threads. Only the thread that owns
+**     a slot writes to it. Threads that did not get a slot update
+**     _unattributed_stats atomically instead.
+**
+**==============================================================================
+*/
+
+static const void* _thread_stats_owners[OE_ALLOCATOR_STATS_MAX_THREADS];
+static oe_allocator_thread_stats_t
+    _thread_stats[OE_ALLOCATOR_STATS_MAX_THREADS];
+static oe_allocator_thread_stats_t _unattributed_stats;
+
+static oe_allocator_thread_stats_t* _thread_stats_get_slot(const void* owner)
+{
+    for (size_t i = 0; i < OE_ALLOCATOR_STATS_MAX_THREADS; i++)
+    {
+        const void* current =
+            __atomic_load_n(&_thread_stats_owners[i], __ATOMIC_ACQUIRE);
+
+        if (!current &&
+            __atomic_compare_exchange_n(
+                &_thread_stats_owners[i],
+                &current,
+                owner,
+                false,
+                __ATOMIC_ACQ_REL,
+                __ATOMIC_ACQUIRE))
+            return &_thread_stats[i];
+
+        if (current == owner)
+            return &_thread_stats[i];
+    }
+
+    return NULL;
+}
+
+static size_t _thread_stats_size_class(size_t size)
+{
+    size_t c;
+
+    if (size <= 16)
+        return 0;
+
+    c = (size_t)(64 - __builtin_clzll((unsigned long long)size - 1)) - 4;
+
+    return c < OE_ALLOCATOR_STATS_SIZE_CLASSES
+               ? c
+               : OE_ALLOCATOR_STATS_SIZE_CLASSES - 1;
+}
+
+static void _thread_stats_add(
+    oe_allocator_thread_stats_t* stats,
+    uint64_t* counter,
+    uint64_t value)
+{
+    if (stats == &_unattributed_stats)
+        __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+    else
+        *counter += value;
+}
+
+/*
+**==============================================================================
+**
+** Thread caches
+**
+**     Each enclave thread keeps the small blocks it frees in per-size-class
+**     magazines, and reuses them without taking the dlmalloc lock. A magazine
+**     that runs empty is refilled with half its capacity of blocks by a single
+**     dlindependent_comalloc call. A full magazine gives half of its blocks
+**     back by a single dlbulk_free call. The caches live in thread-local
+**     storage and are flushed by oe_allocator_thread_cleanup.
+**
+**     A block is cached in the largest class that is not larger than its
+**     usable size, so every block of a class satisfies the requests up to the
+**     size of the class. The blocks held by the caches are counted as
+**     allocated by oe_allocator_mallinfo.
+**
+**==============================================================================
+*/
+
+#define THREAD_CACHE_NUM_CLASSES 14
+#define THREAD_CACHE_MAX_BLOCKS 16
+
+typedef struct _thread_cache_class
+{
+    size_t size;
+    size_t capacity;
+} thread_cache_class_t;
+
+/* Up to 16 blocks and 4 KB per class */
+static const thread_cache_class_t _classes[THREAD_CACHE_NUM_CLASSES] = {
+    {16, 16},
+    {32, 16},
+    {48, 16},
+    {64, 16},
+    {80, 16},
+    {96, 16},
+    {112, 16},
+    {128, 16},
+    {192, 16},
+    {256, 16},
+    {384, 10},
+    {512, 8},
+    {768, 5},
+    {1024, 4},
+};
+
+typedef struct _thread_cache_magazine
+{
+    size_t count;
+    void* blocks[THREAD_CACHE_MAX_BLOCKS];
+} thread_cache_magazine_t;
+
+typedef struct _thread_cache
+{
+    bool enabled;
+    oe_allocator_thread_stats_t* stats;
+    thread_cache_magazine_t magazines[THREAD_CACHE_NUM_CLASSES];
+} thread_cache_t;
+
+static __thread thread_cache_t _thread_cache;
+
+static oe_allocator_thread_stats_t* _thread_stats_get(void)
+{
+    oe_allocator_thread_stats_t* stats = _thread_cache.stats;
+    return stats ? stats : &_unattributed_stats;
+}
+
+static void _thread_stats_malloc(size_t size, void* ptr)
+{
+    oe_allocator_thread_stats_t* stats = _thread_stats_get();
+
+    _thread_stats_add(stats, &stats->allocations, 1);
+    _thread_stats_add(
+        stats, &stats->allocated_bytes, dlmalloc_usable_size(ptr));
+    _thread_stats_add(
+        stats, &stats->size_classes[_thread_stats_size_class(size)], 1);
+}
+
+static void _thread_stats_free(size_t usable_size)
+{
+    oe_allocator_thread_stats_t* stats = _thread_stats_get();
+
+    _thread_stats_add(stats, &stats->frees, 1);
+    _thread_stats_add(stats, &stats->freed_bytes, usable_size);
+}
+
+/* Get the smallest class that satisfies the request */
+static size_t _thread_cache_request_class(size_t size)
+{
+    for (size_t c = 0; c < THREAD_CACHE_NUM_CLASSES; c++)
+    {
+        if (size <= _classes[c].size)
+            return c;
+    }
+
+    return THREAD_CACHE_NUM_CLASSES;
+}
+
+/* Get the largest class the block satisfies */
+static size_t _thread_cache_block_class(size_t usable_size)
+{
+    size_t c = THREAD_CACHE_NUM_CLASSES;
+
+    /* Larger blocks were not allocated for a class */
+    if (usable_size >=
+        _classes[THREAD_CACHE_NUM_CLASSES - 1].size + MALLOC_ALIGNMENT)
+        return THREAD_CACHE_NUM_CLASSES;
+
+    while (c > 0 && _classes[c - 1].size > usable_size)
+        c--;
+
+    return c ? c - 1 : THREAD_CACHE_NUM_CLASSES;
+}
+
+static void* _thread_cache_malloc(size_t size)
+{
+    thread_cache_t* cache = &_thread_cache;
+    thread_cache_magazine_t* magazine;
+    size_t c;
+
+    if (!cache->enabled ||
+        (c = _thread_cache_request_class(size)) == THREAD_CACHE_NUM_CLASSES)
+        return NULL;
+
+    magazine = &cache->magazines[c];
+
+    if (magazine->count == 0)
+    {
+        size_t count = _classes[c].capacity / 2;
+        size_t sizes[THREAD_CACHE_MAX_BLOCKS];
+
+        for (size_t i = 0; i < count; i++)
+            sizes[i] = _classes[c].size;
+
+        if (!dlindependent_comalloc(count, sizes, magazine->blocks))
+            return NULL;
+
+        magazine->count = count;
+    }
+
+    return magazine->blocks[--magazine->count];
+}
+
+static bool _thread_cache_free(void* ptr, size_t usable_size)
+{
+    thread_cache_t* cache = &_thread_cache;
+    thread_cache_magazine_t* magazine;
+    size_t c;
+
+    if (!cache->enabled ||
+        (c = _thread_cache_block_class(usable_size)) ==
+            THREAD_CACHE_NUM_CLASSES)
+        return false;
+
+    magazine = &cache->magazines[c];
+
+    if (magazine->count == _classes[c].capacity)
+    {
+        size_t count = _classes[c].capacity / 2;
+
+        magazine->count -= count;
+        dlbulk_free(&magazine->blocks[magazine->count], count);
+    }
+
+    magazine->blocks[magazine->count++] = ptr;
+    return true;
+}
+
+/* Give all cached blocks back to dlmalloc. Returns whether there were any. */
+static bool _thread_cache_flush(thread_cache_t* cache)
+{
+    bool flushed = false;
+
+    for (size_t c = 0; c < THREAD_CACHE_NUM_CLASSES; c++)
+    {
+        thread_cache_magazine_t* magazine = &cache->magazines[c];
+
+        if (magazine->count)
+        {
+            dlbulk_free(magazine->blocks, magazine->count);
+            magazine->count = 0;
+            flushed = true;
+        }
+    }
+
+    return flushed;
+}
+
 void oe_allocator_init(void* heap_start_address, void* heap_end_address)
 {
     _heap_start = heap_start_address;
@@ -78,40 +341,117 @@ void oe_allocator_cleanup(void)
 
 void oe_allocator_thread_init(void)
 {
+    _thread_cache.enabled = true;
+    _thread_cache.stats = _thread_stats_get_slot(&_thread_cache);
 }
 
 void oe_allocator_thread_cleanup(void)
 {
+    _thread_cache_flush(&_thread_cache);
+    _thread_cache.enabled = false;
+    _thread_cache.stats = NULL;
+}
+
+void oe_allocator_thread_release(ptrdiff_t tls_offset)
+{
+    thread_cache_t* cache =
+        (thread_cache_t*)((uint8_t*)&_thread_cache + tls_offset);
+
+    _thread_cache_flush(cache);
+    cache->enabled = false;
+    cache->stats = NULL;
 }
 
 void* oe_allocator_malloc(size_t size)
 {
-    return dlmalloc(size);
+    void* ptr = _thread_cache_malloc(size);
+
+    /* Blocks cached by this thread may be what the heap is missing */
+    if (!ptr && !(ptr = dlmalloc(size)) &&
+        _thread_cache_flush(&_thread_cache))
+        ptr = dlmalloc(size);
+
+    if (ptr)
+        _thread_stats_malloc(size, ptr);
+
+    return ptr;
 }
 
 void oe_allocator_free(void* ptr)
 {
-    dlfree(ptr);
+    if (ptr)
+    {
+        size_t usable_size = dlmalloc_usable_size(ptr);
+
+        _thread_stats_free(usable_size);
+
+        if (!_thread_cache_free(ptr, usable_size))
+            dlfree(ptr);
+    }
 }
 
 void* oe_allocator_calloc(size_t nmemb, size_t size)
 {
-    return dlcalloc(nmemb, size);
+    void* ptr;
+
+    if (!nmemb || size <= MAX_SIZE_T / nmemb)
+    {
+        size_t total = nmemb * size;
+
+        if ((ptr = _thread_cache_malloc(total)))
+        {
+            memset(ptr, 0, total);
+            _thread_stats_malloc(total, ptr);
+            return ptr;
+        }
+    }
+
+    if (!(ptr = dlcalloc(nmemb, size)) &&
+        _thread_cache_flush(&_thread_cache))
+        ptr = dlcalloc(nmemb, size);
+
+    /* The multiplication cannot overflow if dlcalloc succeeded */
+    if (ptr)
+        _thread_stats_malloc(nmemb * size, ptr);
+
+    return ptr;
 }
 
+/* Resizing a block counts as freeing it and allocating the new one */
 void* oe_allocator_realloc(void* ptr, size_t size)
 {
-    return dlrealloc(ptr, size);
+    size_t usable_size = ptr ? dlmalloc_usable_size(ptr) : 0;
+    void* new_ptr = dlrealloc(ptr, size);
+
+    if (new_ptr)
+    {
+        if (ptr)
+            _thread_stats_free(usable_size);
+
+        _thread_stats_malloc(size, new_ptr);
+    }
+
+    return new_ptr;
 }
 
 void* oe_allocator_aligned_alloc(size_t alignment, size_t size)
 {
-    return dlmemalign(alignment, size);
+    void* ptr = dlmemalign(alignment, size);
+
+    if (ptr)
+        _thread_stats_malloc(size, ptr);
+
+    return ptr;
 }
 
 int oe_allocator_posix_memalign(void** memptr, size_t alignment, size_t size)
 {
-    return dlposix_memalign(memptr, alignment, size);
+    int rc = dlposix_memalign(memptr, alignment, size);
+
+    if (rc == 0)
+        _thread_stats_malloc(size, *memptr);
+
+    return rc;
 }
 
 size_t oe_allocator_malloc_usable_size(void* ptr)
@@ -133,3 +473,39 @@ oe_result_t oe_allocator_mallinfo(oe_mallinfo_t* info)
 
     return OE_OK;
 }
+
+oe_result_t oe_allocator_get_stats(oe_allocator_stats_t* stats)
+{
+    oe_mallinfo_t info;
+
+    if (!stats)
+        return OE_INVALID_PARAMETER;
+
+    memset(stats, 0, sizeof(*stats));
+
+    oe_allocator_mallinfo(&info);
+    stats->max_total_heap_size = info.max_total_heap_size;
+    stats->current_allocated_heap_size = info.current_allocated_heap_size;
+    stats->peak_allocated_heap_size = info.peak_allocated_heap_size;
+
+    ACQUIRE_LOCK(&_lock);
+    stats->heap_high_water_mark = _heap_high_water_mark;
+    RELEASE_LOCK(&_lock);
+
+    for (size_t i = 0; i < OE_ALLOCATOR_STATS_MAX_THREADS; i++)
+    {
+        if (__atomic_load_n(&_thread_stats_owners[i], __ATOMIC_ACQUIRE))
+            stats->threads[stats->num_threads++] = _thread_stats[i];
+    }
+
+    for (size_t c = 0; c < OE_ALLOCATOR_STATS_SIZE_CLASSES; c++)
+    {
+        stats->size_classes[c] = __atomic_load_n(
+            &_unattributed_stats.size_classes[c], __ATOMIC_RELAXED);
+
+        for (size_t i = 0; i < stats->num_threads; i++)
+            stats->size_classes[c] += stats->threads[i].size_classes[c];
+    }
+
+    return OE_OK;
+}
@@ -59,6 +59,19 @@ void oe_allocator_thread_cleanup(void)
     allocator_local = nullptr;
 }
 
+void oe_allocator_thread_release(ptrdiff_t tls_offset)
+{
+    void** other = reinterpret_cast<void**>(
+        reinterpret_cast<uint8_t*>(&snmalloc::allocator_local) + tls_offset);
+
+    if (*other)
+    {
+        current_alloc_pool()->release(
+            static_cast<decltype(ThreadAlloc::get())>(*other));
+        *other = nullptr;
+    }
+}
+
 oe_result_t oe_allocator_mallinfo(oe_mallinfo_t* info)
 {
     info->max_total_heap_size = _max_heap_size;
@@ -68,4 +81,24 @@ oe_result_t oe_allocator_mallinfo(oe_mallinfo_t* info)
     info->peak_allocated_heap_size = _info.peak_memory_usage;
 
     return OE_OK;
-}
\ No newline at end of file
+}
+oe_result_t oe_allocator_get_stats(oe_allocator_stats_t* stats)
+{
+    oe_mallinfo_t info;
+
+    if (!stats)
+        return OE_INVALID_PARAMETER;
+
+    // snmalloc does not count allocations by size or by thread.
+    *stats = oe_allocator_stats_t();
+
+    oe_allocator_mallinfo(&info);
+    stats->max_total_heap_size = info.max_total_heap_size;
+    stats->current_allocated_heap_size = info.current_allocated_heap_size;
+    stats->peak_allocated_heap_size = info.peak_allocated_heap_size;
+
+    // The usage reported by snmalloc is the memory it took from the heap.
+    stats->heap_high_water_mark = info.peak_allocated_heap_size;
+
+    return OE_OK;
+}
@@ -27,6 +27,9 @@ bool oe_use_debug_malloc_tracking = false;
 /* Session number to identify the session of local tracking. */
 int32_t oe_debug_malloc_session_number = 0;
 
+/* Mean number of bytes allocated between two sampled blocks, or zero. */
+static uint64_t _sampling_interval;
+
 /*
 **==============================================================================
 **
@@ -39,13 +42,24 @@ int32_t oe_debug_malloc_session_number = 0;
 **         (3) Assuming blocks are zero filled (fills new blocks with 0xAA).
 **         (3) Use of free memory (fills freed blocks with 0xDD).
 **
-**     This allocator keeps in-use blocks on a linked list. Each block has the
+**     This allocator keeps in-use blocks on linked lists. Each block has the
 **     following layout.
 **
 **         [padding] [header] [user-data] [footer]
 **
 **     The padding is applied by memalign() when the alignment is non-zero.
 **
+**     Threads are spread over NUM_LISTS lists, each with its own lock, so
+**     that they rarely contend. A block is kept on the list of the thread
+**     that allocated it, and its header records which one.
+**
+**     In sampling mode, only a sample of the blocks is tracked, that is,
+**     gets a backtrace and is put on a list. The other blocks only get their
+**     magic numbers checked. As in sampling heap profilers, the number of
+**     bytes allocated between two samples follows an exponential
+**     distribution, so that every byte allocated is equally likely to be
+**     sampled and the samples are not biased by the allocation pattern.
+**
 **==============================================================================
 */
 
@@ -85,8 +99,14 @@ struct header
     /* Option if current object is tracked */
     int32_t session_number;
 
+    /* Index of the list the block is on, if tracked */
+    uint16_t list;
+
+    /* Whether the block has a backtrace and is on a list */
+    uint8_t tracked;
+
     /* Padding to make header a multiple of 16 */
-    uint8_t padding[4];
+    uint8_t padding[1];
 
     /* Contains HEADER_MAGIC2 */
     uint64_t magic2;
@@ -123,7 +143,7 @@ OE_INLINE footer_t* _get_footer(void* ptr)
 }
 
 /* Use a macro so the function name will not appear in the backtrace */
-#define INIT_BLOCK(HEADER, ALIGNMENT, SIZE)                                    \
+#define INIT_BLOCK(HEADER, ALIGNMENT, SIZE, LIST, TRACKED)                     \
     do                                                                         \
     {                                                                          \
         HEADER->magic1 = HEADER_MAGIC1;                                        \
@@ -132,9 +152,12 @@ OE_INLINE footer_t* _get_footer(void* ptr)
         HEADER->alignment = ALIGNMENT;                                         \
         HEADER->size = SIZE;                                                   \
         HEADER->num_addrs =                                                    \
-            (uint64_t)oe_backtrace(HEADER->addrs, OE_BACKTRACE_MAX);           \
+            TRACKED ? (uint64_t)oe_backtrace(HEADER->addrs, OE_BACKTRACE_MAX)  \
+                    : 0;                                                       \
         HEADER->session_number =                                               \
             oe_use_debug_malloc_tracking ? oe_debug_malloc_session_number : 0; \
+        HEADER->list = (uint16_t)(LIST);                                       \
+        HEADER->tracked = TRACKED;                                             \
         HEADER->magic2 = HEADER_MAGIC2;                                        \
         _get_footer(HEADER->data)->magic = FOOTER_MAGIC;                       \
     } while (0)
@@ -199,19 +222,107 @@ OE_INLINE size_t _get_block_size(void* ptr)
     return _calculate_block_size(header->alignment, header->size);
 }
 
+#define NUM_LISTS 64
+
 /* Doubly-linked list of headers */
 typedef struct _list
 {
     header_t* head;
     header_t* tail;
+    oe_spinlock_t lock;
+
+    /* Number of bytes left to allocate before the next sample */
+    int64_t bytes_until_sample;
+
+    /* State of the generator of the sampling intervals */
+    uint64_t random;
 } list_t;
 
-static list_t _list = {NULL, NULL};
+static list_t _lists[NUM_LISTS];
+
+/* Protects the local tracking state */
 static oe_spinlock_t _spin = OE_SPINLOCK_INITIALIZER;
 
+/* Spread the threads over the lists by the address of their thread data */
+static size_t _get_list_index(void)
+{
+    uint64_t self = (uint64_t)oe_thread_self();
+    return (size_t)((self >> 12) ^ (self >> 20)) % NUM_LISTS;
+}
+
+static void _lock_lists(void)
+{
+    for (size_t i = 0; i < NUM_LISTS; i++)
+        oe_spin_lock(&_lists[i].lock);
+}
+
+static void _unlock_lists(void)
+{
+    for (size_t i = NUM_LISTS; i > 0; i--)
+        oe_spin_unlock(&_lists[i - 1].lock);
+}
+
+/* Compute -ln(x / 2^53) for 0 < x < 2^53 in 16.16 fixed point */
+static uint64_t _neg_log_fixed(uint64_t x)
+{
+    const uint64_t exponent = 63 - (uint64_t)__builtin_clzll(x);
+    uint64_t fraction;
+    uint64_t log2;
+
+    /* Fraction of the mantissa of x in 0.32 fixed point */
+    fraction = ((x << (63 - exponent)) >> 31) & 0xffffffff;
+
+    /* log2(1 + f) is about f + 0.3466 * f * (1 - f) */
+    fraction += (((fraction * (0x100000000 - fraction)) >> 32) * 1420) >> 12;
+
+    /* -log2(x / 2^53) in 32.32 fixed point, then multiplied by ln(2) */
+    log2 = ((53 - exponent) << 32) - fraction;
+    return ((log2 >> 16) * 45426) >> 16;
+}
+
+/* Draw the number of bytes until the next sample of the list */
+static int64_t _next_sample_interval(list_t* list, uint64_t interval)
+{
+    uint64_t x = list->random;
+
+    if (!x)
+        x = ((uint64_t)(list - _lists) + 1) * 0x9e3779b97f4a7c15;
+
+    /* xorshift64* */
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    list->random = x;
+    x = ((x * 0x2545f4914f6cdd1d) >> 11) | 1;
+
+    return (int64_t)(((_neg_log_fixed(x) * interval) >> 16) + 1);
+}
+
+/* Decide whether to track a block allocated by this thread */
+static bool _should_track(list_t* list, size_t size)
+{
+    const uint64_t interval = _sampling_interval;
+
+    if (!interval)
+        return true;
+
+    if (__atomic_sub_fetch(
+            &list->bytes_until_sample, (int64_t)size, __ATOMIC_RELAXED) > 0)
+        return false;
+
+    oe_spin_lock(&list->lock);
+    __atomic_store_n(
+        &list->bytes_until_sample,
+        _next_sample_interval(list, interval),
+        __ATOMIC_RELAXED);
+    oe_spin_unlock(&list->lock);
+
+    return true;
+}
+
 static void _list_insert(list_t* list, header_t* header)
 {
-    oe_spin_lock(&_spin);
+    oe_spin_lock(&list->lock);
     {
         if (list->head)
         {
@@ -228,12 +339,12 @@ static void _list_insert(list_t* list, header_t* header)
             list->tail = header;
         }
     }
-    oe_spin_unlock(&_spin);
+    oe_spin_unlock(&list->lock);
 }
 
 static void _list_remove(list_t* list, header_t* header)
 {
-    oe_spin_lock(&_spin);
+    oe_spin_lock(&list->lock);
     {
         if (header->next)
             header->next->prev = header->prev;
@@ -246,7 +357,7 @@ static void _list_remove(list_t* list, header_t* header)
         else if (header == list->tail)
             list->tail = header->prev;
     }
-    oe_spin_unlock(&_spin);
+    oe_spin_unlock(&list->lock);
 }
 
 OE_INLINE bool _check_multiply_overflow(size_t x, size_t y)
@@ -283,33 +394,37 @@ done:
 
 static void _dump(bool need_lock)
 {
-    list_t* list = &_list;
-
     if (need_lock)
-        oe_spin_lock(&_spin);
+        _lock_lists();
 
     {
         size_t blocks = 0;
         size_t bytes = 0;
 
         /* Count bytes allocated and blocks still in use */
-        for (header_t* p = list->head; p; p = p->next)
+        for (size_t i = 0; i < NUM_LISTS; i++)
         {
-            blocks++;
-            bytes += p->size;
+            for (header_t* p = _lists[i].head; p; p = p->next)
+            {
+                blocks++;
+                bytes += p->size;
+            }
         }
 
         oe_host_printf(
             "=== %s(): %zu bytes in %zu blocks\n", __FUNCTION__, bytes, blocks);
 
-        for (header_t* p = list->head; p; p = p->next)
-            _malloc_dump(p->size, p->addrs, (int)p->num_addrs);
+        for (size_t i = 0; i < NUM_LISTS; i++)
+        {
+            for (header_t* p = _lists[i].head; p; p = p->next)
+                _malloc_dump(p->size, p->addrs, (int)p->num_addrs);
+        }
 
         oe_host_printf("\n");
     }
 
     if (need_lock)
-        oe_spin_unlock(&_spin);
+        _unlock_lists();
 }
 
 /*
@@ -324,6 +439,8 @@ void* oe_debug_malloc(size_t size)
 {
     void* block;
     const size_t block_size = _calculate_block_size(0, size);
+    const size_t list = _get_list_index();
+    const bool tracked = _should_track(&_lists[list], size);
 
     if (!(block = oe_allocator_malloc(block_size)))
         return NULL;
@@ -335,9 +452,11 @@ void* oe_debug_malloc(size_t size)
     }
 
     header_t* header = (header_t*)block;
-    INIT_BLOCK(header, 0, size);
+    INIT_BLOCK(header, 0, size, list, tracked);
     _check_block(header);
-    _list_insert(&_list, header);
+
+    if (tracked)
+        _list_insert(&_lists[list], header);
 
     return header->data;
 }
@@ -348,11 +467,14 @@ void oe_debug_free(void* ptr)
     {
         header_t* header = _get_header(ptr);
         _check_block(header);
-        _list_remove(&_list, header);
+
+        if (header->tracked)
+            _list_remove(&_lists[header->list], header);
 
         /* Fill the whole block with 0xDD (Deallocated) bytes */
         void* block = _get_block_address(ptr);
         size_t block_size = _get_block_size(ptr);
+
         oe_memset_s(block, block_size, 0xDD, block_size);
 
         oe_allocator_free(block);
@@ -417,8 +539,10 @@ int oe_debug_posix_memalign(void** memptr, size_t alignment, size_t size)
 {
     const size_t padding_size = _get_padding_size(alignment);
     const size_t block_size = _calculate_block_size(alignment, size);
+    const size_t list = _get_list_index();
     void* block = NULL;
     header_t* header = NULL;
+    bool tracked;
 
     if (!memptr)
         return OE_EINVAL;
@@ -430,10 +554,14 @@ int oe_debug_posix_memalign(void** memptr, size_t alignment, size_t size)
         return OE_ENOMEM;
 
     header = (header_t*)((uint8_t*)block + padding_size);
+    tracked = _should_track(&_lists[list], size);
 
-    INIT_BLOCK(header, alignment, size);
+    INIT_BLOCK(header, alignment, size, list, tracked);
     _check_block(header);
-    _list_insert(&_list, header);
+
+    if (tracked)
+        _list_insert(&_lists[list], header);
+
     *memptr = header->data;
 
     return 0;
@@ -466,23 +594,28 @@ void oe_debug_malloc_dump(void)
 
 size_t oe_debug_malloc_check(void)
 {
-    list_t* list = &_list;
     size_t count = 0;
 
-    oe_spin_lock(&_spin);
+    _lock_lists();
     {
-        for (header_t* p = list->head; p; p = p->next)
-            count++;
+        for (size_t i = 0; i < NUM_LISTS; i++)
+        {
+            for (header_t* p = _lists[i].head; p; p = p->next)
+                count++;
+        }
 
         if (count)
         {
             _dump(false);
 
-            for (header_t* p = list->head; p; p = p->next)
-                _check_block(p);
+            for (size_t i = 0; i < NUM_LISTS; i++)
+            {
+                for (header_t* p = _lists[i].head; p; p = p->next)
+                    _check_block(p);
+            }
         }
     }
-    oe_spin_unlock(&_spin);
+    _unlock_lists();
 
     return count;
 }
@@ -654,6 +787,25 @@ oe_result_t oe_debug_malloc_tracking_stop(void)
     return result;
 }
 
+oe_result_t oe_debug_malloc_set_sampling_interval(uint64_t interval)
+{
+    if (interval > OE_INT32_MAX)
+        return OE_INVALID_PARAMETER;
+
+    _lock_lists();
+    {
+        _sampling_interval = interval;
+
+        /* Sample the next block of every list to start the intervals */
+        for (size_t i = 0; i < NUM_LISTS; i++)
+            __atomic_store_n(
+                &_lists[i].bytes_until_sample, 0, __ATOMIC_RELAXED);
+    }
+    _unlock_lists();
+
+    return OE_OK;
+}
+
 static oe_result_t _copy_frames(
     header_t* p,
     char** str,
@@ -681,12 +833,14 @@ static oe_result_t _copy_frames(
                 *size *= 2;
             }
 
-            *str = oe_realloc(*str, *size);
-            if (*str == NULL)
+            /* Bypass debug malloc, whose lists are locked by the caller */
+            char* new_str = oe_allocator_realloc(*str, *size);
+            if (new_str == NULL)
             {
                 result = OE_ENOMEM;
                 goto done;
             }
+            *str = new_str;
         }
 
         oe_snprintf(
@@ -714,44 +868,52 @@ oe_result_t oe_debug_malloc_tracking_report(
 
     size_t index = 0;
     size_t length = 4096;
-    char* report_string = oe_malloc(length);
-    if (!report_string)
+    char* report_string = NULL;
+
+    /* Build the report outside of debug malloc, whose lists are locked */
+    char* buffer = oe_allocator_malloc(length);
+    if (!buffer)
     {
         result = OE_ENOMEM;
         goto done;
     }
-    report_string[0] = '\0';
+    buffer[0] = '\0';
 
-    list_t* list = &_list;
-    oe_spin_lock(&_spin);
+    for (size_t i = 0; i < NUM_LISTS; i++)
     {
+        list_t* list = &_lists[i];
+
+        oe_spin_lock(&list->lock);
         for (header_t* p = list->head; p; p = p->next)
         {
             if (p->session_number)
             {
                 count++;
-                result = _copy_frames(p, &report_string, &length, &index);
+                result = _copy_frames(p, &buffer, &length, &index);
                 if (result != OE_OK)
-                {
-                    goto done;
-                }
+                    break;
             }
         }
+        oe_spin_unlock(&list->lock);
+
+        if (result != OE_OK)
+            goto done;
     }
-    oe_spin_unlock(&_spin);
 
+    /* The caller frees the report with oe_free() */
     length = index + 1;
-    report_string = oe_realloc(report_string, length);
+    report_string = oe_malloc(length);
     if (!report_string)
     {
         result = OE_ENOMEM;
         goto done;
     }
+    oe_memcpy_s(report_string, length, buffer, length);
 
     *out_object_count = count;
     *report = report_string;
 
 done:
-    oe_spin_unlock(&_spin);
+    oe_allocator_free(buffer);
     return result;
 }
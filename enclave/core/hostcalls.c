@@ -12,6 +12,7 @@
 #include <openenclave/internal/stack_alloc.h>
 
 #include "core_t.h"
+#include "hostheap.h"
 
 /**
  * Declare the prototypes of the following functions to avoid the
@@ -67,6 +68,17 @@ void* oe_host_malloc(size_t size)
     return (void*)arg_out;
 }
 
+void* oe_host_heap_allocate(size_t size)
+{
+    void* ptr;
+
+    /* Serve the allocation without an OCALL if possible */
+    if ((ptr = oe_host_heap_malloc(size)))
+        return ptr;
+
+    return oe_host_malloc(size);
+}
+
 void* oe_host_calloc(size_t nmemb, size_t size)
 {
     size_t total_size;
@@ -94,10 +106,31 @@ OE_WEAK_ALIAS(_oe_realloc_ocall, oe_realloc_ocall);
 void* oe_host_realloc(void* ptr, size_t size)
 {
     void* retval = NULL;
+    size_t old_size;
 
     if (!ptr)
         return oe_host_malloc(size);
 
+    /* Memory of the enclave's host heap is unknown to the host's realloc() */
+    if ((old_size = oe_host_heap_usable_size(ptr)))
+    {
+        if (size == 0)
+        {
+            oe_host_free(ptr);
+            return NULL;
+        }
+
+        if (size <= old_size)
+            return ptr;
+
+        if (!(retval = oe_host_heap_allocate(size)))
+            return NULL;
+
+        oe_memcpy_s(retval, size, ptr, old_size);
+        oe_host_free(ptr);
+        return retval;
+    }
+
     if (oe_realloc_ocall(&retval, ptr, size) != OE_OK)
         return NULL;
 
@@ -112,6 +145,9 @@ void* oe_host_realloc(void* ptr, size_t size)
 
 void oe_host_free(void* ptr)
 {
+    if (oe_host_heap_free(ptr))
+        return;
+
     oe_ocall(OE_OCALL_FREE, (uint64_t)ptr, NULL);
 }
 
@@ -0,0 +1,56 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOSTHEAP_H
+#define _OE_HOSTHEAP_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/**
+ * Allocate **size** bytes of host memory without leaving the enclave.
+ *
+ * @returns The allocated memory, or NULL if the request cannot be served by
+ * the host heap of the enclave, in which case the caller must allocate the
+ * memory with an OCALL.
+ */
+void* oe_host_heap_malloc(size_t size);
+
+/**
+ * Allocate **size** bytes of host memory for the SDK's own use, from the host
+ * heap of the enclave if possible and with oe_host_malloc() otherwise.
+ *
+ * The memory must be released by the enclave with oe_host_free(). Unlike the
+ * memory returned by oe_host_malloc(), it must never be passed to the host
+ * to be freed.
+ */
+void* oe_host_heap_allocate(size_t size);
+
+/**
+ * Release memory allocated with oe_host_heap_malloc().
+ *
+ * @returns true if **ptr** was allocated by the host heap of the enclave and
+ * has been released, or false if **ptr** does not belong to it.
+ */
+bool oe_host_heap_free(void* ptr);
+
+/**
+ * Get the usable size of memory allocated with oe_host_heap_malloc().
+ *
+ * @returns The number of bytes usable at **ptr**, or 0 if **ptr** does not
+ * belong to the host heap of the enclave.
+ */
+size_t oe_host_heap_usable_size(void* ptr);
+
+/**
+ * Return the memory of the host heap to the host. Called when the enclave
+ * is terminated. The host heap allocates nothing afterwards, and releasing
+ * one of its blocks does nothing.
+ */
+void oe_host_heap_cleanup(void);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOSTHEAP_H */
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include <openenclave/advanced/allocator.h>
+#include <openenclave/advanced/mallinfo.h>
 #include <openenclave/corelibc/stdlib.h>
 #include <openenclave/internal/fault.h>
 #include <openenclave/internal/globals.h>
@@ -9,6 +10,7 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/safecrt.h>
 #include <openenclave/internal/utils.h>
+#include "core_t.h"
 
 static oe_allocation_failure_callback_t _failure_callback;
 
@@ -93,6 +95,46 @@ size_t oe_malloc_usable_size(void* ptr)
     return oe_allocator_malloc_usable_size(ptr);
 }
 
+/*
+ * Allocators that do not implement oe_allocator_get_stats() report that it
+ * is not supported.
+ */
+oe_result_t _oe_allocator_get_stats(oe_allocator_stats_t* stats);
+
+oe_result_t _oe_allocator_get_stats(oe_allocator_stats_t* stats)
+{
+    OE_UNUSED(stats);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_allocator_get_stats, oe_allocator_get_stats);
+
+/*
+ * Allocators that do not implement oe_allocator_thread_release() keep the
+ * state of the threads that they cannot clean up themselves.
+ */
+void _oe_allocator_thread_release(ptrdiff_t tls_offset);
+
+void _oe_allocator_thread_release(ptrdiff_t tls_offset)
+{
+    OE_UNUSED(tls_offset);
+}
+OE_WEAK_ALIAS(_oe_allocator_thread_release, oe_allocator_thread_release);
+
+oe_result_t oe_get_allocator_stats_ecall(void* stats, size_t stats_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!stats || stats_size != sizeof(oe_allocator_stats_t))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK_NO_TRACE(oe_allocator_get_stats((oe_allocator_stats_t*)stats));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 // Dummy item in malloc.c for the real variables and functions in debugmalloc.c
 bool oe_disable_debug_malloc_check;
 
@@ -112,6 +154,12 @@ oe_result_t oe_debug_malloc_tracking_stop(void)
     return OE_OK;
 }
 
+oe_result_t oe_debug_malloc_set_sampling_interval(uint64_t interval)
+{
+    OE_UNUSED(interval);
+    return OE_OK;
+}
+
 oe_result_t oe_debug_malloc_tracking_report(
     uint64_t* out_object_count,
     char** report)
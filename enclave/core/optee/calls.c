@@ -71,3 +71,22 @@ oe_result_t oe_call_host_function(
         output_bytes_written,
         false /* non-switchless */);
 }
+
+bool oe_is_switchless_initialized(void)
+{
+    // Switchless calls for op-tee: TODO
+    return false;
+}
+
+oe_result_t oe_set_switchless_arena_watermark(size_t watermark)
+{
+    OE_UNUSED(watermark);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_get_switchless_arena_statistics(
+    oe_switchless_arena_statistics_t* statistics)
+{
+    OE_UNUSED(statistics);
+    return OE_UNSUPPORTED;
+}
@@ -4,6 +4,7 @@
 #include <openenclave/corelibc/stdlib.h>
 #include <openenclave/edger8r/enclave.h>
 #include <openenclave/enclave.h>
+#include "../hostheap.h"
 
 // Function used by oeedger8r for allocating ocall buffers. This function can be
 // optimized by allocating a buffer for making ocalls and pass it in to the
@@ -35,3 +36,64 @@ void oe_deallocate_arena(void* buffer)
 {
     OE_UNUSED(buffer);
 }
+
+// Host memory is allocated with OCALLs in OP-TEE.
+void* oe_host_heap_malloc(size_t size)
+{
+    OE_UNUSED(size);
+    return NULL;
+}
+
+bool oe_host_heap_free(void* ptr)
+{
+    OE_UNUSED(ptr);
+    return false;
+}
+
+size_t oe_host_heap_usable_size(void* ptr)
+{
+    OE_UNUSED(ptr);
+    return 0;
+}
+
+void oe_host_heap_cleanup(void)
+{
+}
+
+// Shared memory regions are not supported in OP-TEE.
+oe_result_t oe_shared_memory_read(
+    uint64_t region_id,
+    size_t offset,
+    void* buffer,
+    size_t size)
+{
+    OE_UNUSED(region_id);
+    OE_UNUSED(offset);
+    OE_UNUSED(buffer);
+    OE_UNUSED(size);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_shared_memory_write(
+    uint64_t region_id,
+    size_t offset,
+    const void* buffer,
+    size_t size)
+{
+    OE_UNUSED(region_id);
+    OE_UNUSED(offset);
+    OE_UNUSED(buffer);
+    OE_UNUSED(size);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_shared_memory_get(
+    uint64_t region_id,
+    void** address,
+    size_t* size)
+{
+    OE_UNUSED(region_id);
+    OE_UNUSED(address);
+    OE_UNUSED(size);
+    return OE_UNSUPPORTED;
+}
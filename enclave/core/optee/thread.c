@@ -469,3 +469,9 @@ void oe_thread_destruct_specific(void)
         oe_spin_unlock(&_lock);
     }
 }
+
+/* Persistent thread-local storage is not supported on OP-TEE */
+oe_result_t oe_reset_thread_locals(void)
+{
+    return OE_UNSUPPORTED;
+}
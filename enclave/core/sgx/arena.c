@@ -4,6 +4,7 @@
 #include "arena.h"
 #include <openenclave/corelibc/string.h>
 #include <openenclave/edger8r/common.h>
+#include <openenclave/enclave.h>
 #include <openenclave/internal/print.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/safemath.h>
@@ -11,11 +12,40 @@
 #include <openenclave/internal/thread.h>
 #include <openenclave/internal/utils.h>
 
+/*
+**==============================================================================
+**
+** Shared memory arenas
+**
+**     Each thread allocates the buffers of its switchless calls from a chain
+**     of host chunks. The first chunk has the configured capacity. When an
+**     allocation does not fit in the rest of the current chunk, it moves on
+**     to the next chunk, which is added on demand with at least twice the
+**     capacity of the previous one. The offsets of the arena run through the
+**     chunks one after the other, so that `used` and `floor` are plain
+**     offsets whatever the number of chunks.
+**
+**     oe_arena_free_all() gives the chunks that take the capacity of the
+**     arena above the watermark back to the host, except the chunks that
+**     hold pinned allocations. Chunks below the watermark are kept so that
+**     the next calls with large payloads do not allocate host memory again.
+**
+**==============================================================================
+*/
+
 // Default shared memory arena capacity is 1 mb
 static size_t _capacity = 1024 * 1024;
 
 static const size_t _max_capacity = 1 << 30;
 
+// Capacity that arenas keep after oe_arena_free_all(), 16 mb by default
+static size_t _watermark = 16 * 1024 * 1024;
+
+// Arena growth counters of all threads
+static uint64_t _grow_count;
+static uint64_t _grow_bytes;
+static uint64_t _trim_count;
+
 void* oe_allocate_arena(size_t capacity);
 void oe_deallocate_arena(void* buffer);
 
@@ -35,27 +65,109 @@ bool oe_configure_arena_capacity(size_t cap)
     return true;
 }
 
+oe_result_t oe_set_switchless_arena_watermark(size_t watermark)
+{
+    __atomic_store_n(&_watermark, watermark, __ATOMIC_SEQ_CST);
+    return OE_OK;
+}
+
+oe_result_t oe_get_switchless_arena_statistics(
+    oe_switchless_arena_statistics_t* statistics)
+{
+    if (!statistics)
+        return OE_INVALID_PARAMETER;
+
+    statistics->grow_count = __atomic_load_n(&_grow_count, __ATOMIC_RELAXED);
+    statistics->grow_bytes = __atomic_load_n(&_grow_bytes, __ATOMIC_RELAXED);
+    statistics->trim_count = __atomic_load_n(&_trim_count, __ATOMIC_RELAXED);
+
+    return OE_OK;
+}
+
+/* Give the chunks after the given one back to the host */
+static void _remove_chunks_after(oe_shared_memory_arena_t* arena, size_t index)
+{
+    while (arena->num_chunks > index + 1)
+    {
+        oe_shared_memory_arena_chunk_t* chunk =
+            &arena->chunks[--arena->num_chunks];
+
+        oe_deallocate_arena(chunk->buffer);
+        chunk->buffer = NULL;
+        chunk->capacity = 0;
+        __atomic_add_fetch(&_trim_count, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/* Add a chunk that can hold at least size bytes to the end of the chain */
+static bool _add_chunk(oe_shared_memory_arena_t* arena, size_t size)
+{
+    oe_shared_memory_arena_chunk_t* chunk;
+    size_t capacity = __atomic_load_n(&_capacity, __ATOMIC_SEQ_CST);
+    void* buffer;
+
+    if (arena->num_chunks == OE_SHARED_MEMORY_ARENA_MAX_CHUNKS)
+        return false;
+
+    if (arena->num_chunks)
+    {
+        const size_t last = arena->chunks[arena->num_chunks - 1].capacity;
+
+        if (capacity < 2 * last)
+            capacity = 2 * last;
+    }
+
+    if (capacity < size)
+        capacity = size;
+
+    if (capacity > _max_capacity)
+    {
+        if (size > _max_capacity)
+            return false;
+
+        capacity = _max_capacity;
+    }
+
+    if (!(buffer = oe_allocate_arena(capacity)))
+        return false;
+
+    chunk = &arena->chunks[arena->num_chunks++];
+    chunk->buffer = (uint8_t*)buffer;
+    chunk->capacity = capacity;
+
+    if (arena->num_chunks > 1)
+    {
+        __atomic_add_fetch(&_grow_count, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&_grow_bytes, capacity, __ATOMIC_RELAXED);
+    }
+
+    return true;
+}
+
+/* Set the offset of the next allocation and find the chunk it lies in */
+static void _set_used(oe_shared_memory_arena_t* arena, uint64_t used)
+{
+    uint64_t index = 0;
+    uint64_t start = 0;
+
+    while (index + 1 < arena->num_chunks &&
+           used >= start + arena->chunks[index].capacity)
+    {
+        start += arena->chunks[index].capacity;
+        index++;
+    }
+
+    arena->used = used;
+    arena->current = index;
+    arena->current_start = start;
+}
+
 void* oe_arena_malloc(size_t size)
 {
-    oe_result_t result = OE_UNEXPECTED;
     size_t total_size = 0;
     const size_t align = OE_EDGER8R_BUFFER_ALIGNMENT;
     oe_shared_memory_arena_t* arena = _get_arena();
 
-    // Create the arena if it hasn't been created.
-    if (arena->buffer == NULL)
-    {
-        arena->capacity = __atomic_load_n(&_capacity, __ATOMIC_SEQ_CST);
-        void* buffer = oe_allocate_arena(arena->capacity);
-        if (buffer == NULL)
-        {
-            arena->capacity = 0;
-            return NULL;
-        }
-        arena->buffer = (uint8_t*)buffer;
-        arena->used = 0;
-    }
-
     // Round up to the nearest alignment size.
     total_size = oe_round_up_to_multiple(size, align);
 
@@ -63,20 +175,43 @@ void* oe_arena_malloc(size_t size)
     if (total_size < size)
         return NULL;
 
-    // check for capacity
-    size_t used_after;
-    OE_CHECK(oe_safe_add_sizet(arena->used, total_size, &used_after));
-
-    // Ok if the incoming malloc puts us below the capacity.
-    if (used_after <= arena->capacity)
+    // Create the arena if it hasn't been created.
+    if (arena->num_chunks == 0)
     {
-        uint8_t* addr = arena->buffer + arena->used;
-        arena->used = used_after;
-        return addr;
+        if (!_add_chunk(arena, total_size))
+            return NULL;
+
+        _set_used(arena, 0);
     }
 
-done:
-    return NULL;
+    for (;;)
+    {
+        const oe_shared_memory_arena_chunk_t* chunk =
+            &arena->chunks[arena->current];
+        const uint64_t offset = arena->used - arena->current_start;
+        const uint64_t next_start = arena->current_start + chunk->capacity;
+
+        // Ok if the incoming malloc fits in the rest of the current chunk.
+        if (total_size <= chunk->capacity - offset)
+        {
+            arena->used += total_size;
+            return chunk->buffer + offset;
+        }
+
+        // Otherwise move on to the next chunk. The chunks after the current
+        // one are empty, so replace the next one if it is too small.
+        if (arena->current + 1 < arena->num_chunks &&
+            arena->chunks[arena->current + 1].capacity < total_size)
+            _remove_chunks_after(arena, arena->current);
+
+        if (arena->current + 1 == arena->num_chunks &&
+            !_add_chunk(arena, total_size))
+            return NULL;
+
+        arena->current++;
+        arena->current_start = next_start;
+        arena->used = next_start;
+    }
 }
 
 void* oe_arena_calloc(size_t num, size_t size)
@@ -96,7 +231,47 @@ void* oe_arena_calloc(size_t num, size_t size)
 void oe_arena_free_all()
 {
     oe_shared_memory_arena_t* arena = _get_arena();
-    arena->used = 0;
+    const size_t watermark = __atomic_load_n(&_watermark, __ATOMIC_SEQ_CST);
+    uint64_t capacity = 0;
+    size_t keep = 0;
+
+    // Allocations made before the last pin belong to asynchronous calls that
+    // the host may still be accessing.
+    _set_used(arena, arena->pinned ? arena->floor : 0);
+
+    // Keep the first chunk, the chunk the next allocation goes to, and the
+    // chunks that fit below the watermark.
+    while (keep + 1 < arena->num_chunks &&
+           (keep < arena->current ||
+            capacity + arena->chunks[keep].capacity +
+                    arena->chunks[keep + 1].capacity <=
+                watermark))
+    {
+        capacity += arena->chunks[keep].capacity;
+        keep++;
+    }
+
+    _remove_chunks_after(arena, keep);
+}
+
+void oe_arena_pin()
+{
+    oe_shared_memory_arena_t* arena = _get_arena();
+    arena->floor = arena->used;
+    arena->pinned++;
+}
+
+void oe_arena_unpin()
+{
+    oe_shared_memory_arena_t* arena = _get_arena();
+
+    if (arena->pinned && --arena->pinned == 0)
+    {
+        // Do not touch arena->used here. The caller may have allocated
+        // buffers for its next call already; the next oe_arena_free_all()
+        // reclaims the whole arena.
+        arena->floor = 0;
+    }
 }
 
 // Free the arena in the current thread.
@@ -104,7 +279,13 @@ void oe_teardown_arena()
 {
     oe_shared_memory_arena_t* arena = _get_arena();
 
-    if (arena->buffer != NULL)
-        oe_deallocate_arena(arena->buffer);
+    // If asynchronous calls are still outstanding, the host may still write
+    // to the arena. Leak it rather than handing the memory back to the host
+    // allocator while it is in use.
+    if (!arena->pinned)
+    {
+        for (size_t i = 0; i < arena->num_chunks; i++)
+            oe_deallocate_arena(arena->chunks[i].buffer);
+    }
     memset(arena, 0, sizeof(oe_shared_memory_arena_t));
 }
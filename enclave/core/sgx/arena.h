@@ -6,6 +6,7 @@
 
 #include <openenclave/bits/types.h>
 
+/* Set the capacity of the first host chunk of the arenas */
 bool oe_configure_arena_capacity(size_t cap);
 
 void* oe_arena_malloc(size_t size);
@@ -14,6 +15,12 @@ void* oe_arena_calloc(size_t num, size_t size);
 
 void oe_arena_free_all();
 
+/* Keep the current allocations alive across oe_arena_free_all() until a
+ * matching oe_arena_unpin(). Used by asynchronous switchless calls. */
+void oe_arena_pin();
+
+void oe_arena_unpin();
+
 void oe_teardown_arena();
 
 #endif /* _OE_ARENA_H */
@@ -30,6 +30,7 @@
 #include "../../../common/sgx/sgxmeasure.h"
 #include "../../sgx/report.h"
 #include "../atexit.h"
+#include "../hostheap.h"
 #include "../tracee.h"
 #include "arena.h"
 #include "asmdefs.h"
@@ -194,6 +195,74 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** _get_ecall_buffer()
+**
+**     Return the calling thread's marshaling buffer, grown to hold at least
+**     size bytes, or NULL if the ECALL is too large for it. Each TCS keeps its
+**     buffer across ECALLs so that ECALLs do not contend on the heap lock. The
+**     buffer may grow up to a share of the heap configured in the enclave
+**     properties. It lives as long as the enclave, so it is allocated with
+**     the allocator directly rather than with the tracked oe_malloc().
+**
+**     Also return NULL while an ECALL of this TCS is using the buffer. The
+**     switchless ECALLs run by an enclave worker are nested in the ECALL of
+**     the worker, and must neither overwrite nor free its buffer.
+**
+**==============================================================================
+*/
+
+#define OE_ECALL_BUFFER_MIN_SIZE (4 * 1024)
+#define OE_ECALL_BUFFER_MAX_SIZE (64 * 1024)
+#define OE_ECALL_BUFFER_HEAP_SHARE (64)
+
+static uint8_t* _get_ecall_buffer(oe_sgx_td_t* td, size_t size)
+{
+    if (td->ecall_buffer_in_use)
+        return NULL;
+
+    if (size > td->ecall_buffer_size)
+    {
+        size_t max_size = __oe_get_heap_size() / OE_ECALL_BUFFER_HEAP_SHARE;
+        size_t new_size = 2 * td->ecall_buffer_size;
+        uint8_t* buffer;
+
+        if (max_size > OE_ECALL_BUFFER_MAX_SIZE)
+            max_size = OE_ECALL_BUFFER_MAX_SIZE;
+
+        if (size > max_size)
+            return NULL;
+
+        if (new_size < OE_ECALL_BUFFER_MIN_SIZE)
+            new_size = OE_ECALL_BUFFER_MIN_SIZE;
+
+        if (new_size < size)
+            new_size = size;
+
+        if (new_size > max_size)
+            new_size = max_size;
+
+        // The contents need not be preserved. A zero-filled buffer has no
+        // dirty bytes.
+        if (!(buffer = oe_allocator_calloc(1, new_size)))
+            return NULL;
+
+        // The buffer outlives the ECALL, so record the td to free it at
+        // termination.
+        if (!td->ecall_buffer)
+            td_register(td);
+
+        oe_allocator_free(td->ecall_buffer);
+        td->ecall_buffer = buffer;
+        td->ecall_buffer_size = new_size;
+        td->ecall_buffer_dirty_size = 0;
+    }
+
+    return td->ecall_buffer;
+}
+
 /**
  * This is the preferred way to call enclave functions.
  */
@@ -203,11 +272,14 @@ oe_result_t oe_handle_call_enclave_function(uint64_t arg_in)
     oe_result_t result = OE_OK;
     oe_ecall_func_t func = NULL;
     uint8_t* buffer = NULL;
+    uint8_t* heap_buffer = NULL;
     uint8_t* input_buffer = NULL;
     uint8_t* output_buffer = NULL;
     size_t buffer_size = 0;
+    size_t output_clear_size = 0;
     size_t output_bytes_written = 0;
     ecall_table_t ecall_table;
+    oe_sgx_td_t* td = oe_sgx_get_td();
 
     // Ensure that args lies outside the enclave.
     if (!oe_is_outside_enclave(
@@ -257,19 +329,43 @@ oe_result_t oe_handle_call_enclave_function(uint64_t arg_in)
     if (func == NULL)
         OE_RAISE(OE_NOT_FOUND);
 
-    // Allocate buffers in enclave memory
-    buffer = input_buffer = oe_malloc(buffer_size);
-    if (buffer == NULL)
-        OE_RAISE(OE_OUT_OF_MEMORY);
+    // Use the thread's marshaling buffer, or allocate buffers in enclave
+    // memory for ECALLs too large for it.
+    if ((buffer = _get_ecall_buffer(td, buffer_size)) != NULL)
+    {
+        // Only the bytes that earlier ECALLs may have written need clearing.
+        if (td->ecall_buffer_dirty_size > args.input_buffer_size)
+            output_clear_size =
+                td->ecall_buffer_dirty_size - args.input_buffer_size;
+
+        if (output_clear_size > args.output_buffer_size)
+            output_clear_size = args.output_buffer_size;
+
+        // The buffer is at most OE_ECALL_BUFFER_MAX_SIZE bytes.
+        if (td->ecall_buffer_dirty_size < buffer_size)
+            td->ecall_buffer_dirty_size = (uint32_t)buffer_size;
+
+        td->ecall_buffer_in_use = 1;
+    }
+    else
+    {
+        buffer = heap_buffer = oe_malloc(buffer_size);
+        if (buffer == NULL)
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        output_clear_size = args.output_buffer_size;
+    }
+
+    input_buffer = buffer;
 
     // Copy input buffer to enclave buffer.
     memcpy(input_buffer, args.input_buffer, args.input_buffer_size);
 
     // Clear out output buffer.
     // This ensures reproducible behavior if say the function is reading from
-    // output buffer.
+    // output buffer, and that no stale enclave data is copied to the host.
     output_buffer = buffer + args.input_buffer_size;
-    memset(output_buffer, 0, args.output_buffer_size);
+    memset(output_buffer, 0, output_clear_size);
 
     // Call the function.
     func(
@@ -295,9 +391,157 @@ oe_result_t oe_handle_call_enclave_function(uint64_t arg_in)
     }
 
 done:
-    if (buffer)
-        oe_free(buffer);
+    if (heap_buffer)
+        oe_free(heap_buffer);
+    else if (buffer)
+        td->ecall_buffer_in_use = 0;
+
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** _handle_call_enclave_function_inline()
+**
+**     Handle OE_ECALL_CALL_ENCLAVE_FUNCTION_INLINE: call an enclave function
+**     whose input and output are carried in the arguments. The arguments are
+**     checked once and the input is copied to the stack with them, so the
+**     call needs neither the marshaling buffer nor the heap.
+**
+**==============================================================================
+*/
+
+static oe_result_t _handle_call_enclave_function_inline(uint64_t arg_in)
+{
+    oe_call_enclave_function_inline_args_t* args_ptr =
+        (oe_call_enclave_function_inline_args_t*)arg_in;
+    OE_ALIGNED(OE_CALL_INLINE_BUFFER_ALIGNMENT)
+    uint8_t buffer[OE_CALL_INLINE_BUFFER_SIZE];
+    uint8_t* output_buffer = NULL;
+    uint64_t function_id = 0;
+    size_t input_buffer_size = 0;
+    size_t output_buffer_size = 0;
+    size_t output_offset = 0;
+    size_t output_bytes_written = 0;
+    oe_ecall_func_t func = NULL;
+    oe_result_t result = OE_OK;
+
+    OE_STATIC_ASSERT(
+        OE_CALL_INLINE_BUFFER_ALIGNMENT % OE_EDGER8R_BUFFER_ALIGNMENT == 0);
+
+    if (!oe_is_outside_enclave(args_ptr, sizeof(*args_ptr)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Read the sizes once to avoid TOCTOU issues.
+    function_id = args_ptr->function_id;
+    input_buffer_size = args_ptr->input_buffer_size;
+    output_buffer_size = args_ptr->output_buffer_size;
+
+    // Both buffers must be able to hold at least an oe_result_t and fit in
+    // the inline area.
+    if (input_buffer_size < sizeof(oe_result_t) ||
+        input_buffer_size > OE_CALL_INLINE_BUFFER_SIZE ||
+        output_buffer_size < sizeof(oe_result_t) ||
+        output_buffer_size > OE_CALL_INLINE_BUFFER_SIZE)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    output_offset = OE_CALL_INLINE_OUTPUT_OFFSET(input_buffer_size);
+
+    if (output_offset > OE_CALL_INLINE_BUFFER_SIZE - output_buffer_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (function_id >= __oe_ecalls_table_size)
+        OE_RAISE(OE_NOT_FOUND);
+
+    if ((func = __oe_ecalls_table[function_id]) == NULL)
+        OE_RAISE(OE_NOT_FOUND);
+
+    // Copy the input and clear the output so that no stale enclave data is
+    // copied to the host.
+    output_buffer = buffer + output_offset;
+    memcpy(buffer, args_ptr->buffer, input_buffer_size);
+    memset(output_buffer, 0, output_buffer_size);
+
+    func(
+        buffer,
+        input_buffer_size,
+        output_buffer,
+        output_buffer_size,
+        &output_bytes_written);
+
+    // The output_buffer is expected to point to a marshaling struct,
+    // whose first field is an oe_result_t.
+    result = *(oe_result_t*)output_buffer;
+
+    if (result == OE_OK)
+    {
+        if (output_bytes_written > output_buffer_size)
+            OE_RAISE(OE_UNEXPECTED);
+
+        memcpy(
+            args_ptr->buffer + output_offset,
+            output_buffer,
+            output_bytes_written);
+        args_ptr->output_bytes_written = output_bytes_written;
+        args_ptr->result = OE_OK;
+    }
+
+done:
+    return result;
+}
 
+/*
+**==============================================================================
+**
+** _handle_call_enclave_functions()
+**
+**     Handle OE_ECALL_CALL_ENCLAVE_FUNCTIONS: dispatch a batch of enclave
+**     functions in order within a single ECALL. Each call is validated by
+**     oe_handle_call_enclave_function() and its status is stored in its
+**     result field.
+**
+**==============================================================================
+*/
+static oe_result_t _handle_call_enclave_functions(uint64_t arg_in)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_enclave_functions_args_t args;
+    size_t calls_size = 0;
+
+    // Ensure that args lies outside the enclave.
+    if (!oe_is_outside_enclave(
+            (void*)arg_in, sizeof(oe_call_enclave_functions_args_t)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Copy args to enclave memory to avoid TOCTOU issues.
+    args = *(oe_call_enclave_functions_args_t*)arg_in;
+
+    if (args.calls == NULL || args.num_calls == 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_safe_mul_sizet(
+        args.num_calls, sizeof(oe_call_enclave_function_args_t), &calls_size));
+
+    // Ensure that the call descriptors lie outside the enclave.
+    if (!oe_is_outside_enclave(args.calls, calls_size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (size_t i = 0; i < args.num_calls; i++)
+    {
+        oe_call_enclave_function_args_t* call = &args.calls[i];
+        oe_result_t call_result =
+            oe_handle_call_enclave_function((uint64_t)call);
+
+        // oe_handle_call_enclave_function only reports success in the
+        // descriptor; report failures too so that the host sees every status.
+        if (call_result != OE_OK)
+            call->result = call_result;
+    }
+
+    result = OE_OK;
+
+done:
     return result;
 }
 
@@ -361,6 +605,10 @@ static void _handle_ecall(
 
     td_push_callsite(td, &callsite);
 
+    /* Bind the thread-local storage kept across ECALLs to this host thread */
+    if (oe_sgx_persistent_thread_locals && td->depth == 1)
+        td_bind_thread_locals(td, oe_ecall_context_get_host_thread());
+
     // Acquire release semantics for __oe_initialized are present in
     // _handle_init_enclave.
     if (!__oe_initialized)
@@ -403,8 +651,22 @@ static void _handle_ecall(
             arg_out = oe_handle_call_enclave_function(arg_in);
             break;
         }
+        case OE_ECALL_CALL_ENCLAVE_FUNCTIONS:
+        {
+            arg_out = _handle_call_enclave_functions(arg_in);
+            break;
+        }
+        case OE_ECALL_CALL_ENCLAVE_FUNCTION_INLINE:
+        {
+            arg_out = _handle_call_enclave_function_inline(arg_in);
+            break;
+        }
         case OE_ECALL_DESTRUCTOR:
         {
+            /* Release the thread-local storage kept by every TCS */
+            if (oe_sgx_persistent_thread_locals)
+                td_release_all_thread_locals(td);
+
             /* Call functions installed by oe_cxa_atexit() and oe_atexit() */
             oe_call_atexit_functions();
 
@@ -417,6 +679,9 @@ static void _handle_ecall(
             /* Cleanup verifiers */
             oe_verifier_shutdown();
 
+            /* Free the ECALL buffers of every TCS */
+            td_release_all_ecall_buffers();
+
             /* If memory still allocated, print a trace and return an error */
             OE_CHECK(oe_check_memory_leaks());
 
@@ -451,6 +716,11 @@ done:
         oe_teardown_arena();
     }
 
+    /* Return the memory of the host heap to the host once the arena, whose
+     * chunks may come from it, is released */
+    if (func == OE_ECALL_DESTRUCTOR)
+        oe_host_heap_cleanup();
+
     /* Remove ECALL context from front of oe_sgx_td_t.ecalls list */
     td_pop_callsite(td);
 
@@ -788,6 +1058,112 @@ oe_result_t oe_call_host_function(
         false /* non-switchless */);
 }
 
+/*
+**==============================================================================
+**
+** oe_call_host_functions()
+**
+** Perform a batch of host function calls with a single OCALL. The call
+** descriptors are copied to host memory (the ecall context's ocall buffer if
+** it is large enough) and the results are copied back once the host has
+** dispatched all of them.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_call_host_functions(
+    oe_host_function_call_t* calls,
+    size_t num_calls)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_host_functions_args_t* args = NULL;
+    oe_call_host_function_args_t* host_calls = NULL;
+    size_t host_calls_size = 0;
+    void* buffer = NULL;
+    size_t buffer_size = 0;
+    bool buffer_is_host_allocated = false;
+
+    if (!calls || num_calls == 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // The host reads and writes the buffers directly, so they must not expose
+    // enclave memory.
+    for (size_t i = 0; i < num_calls; i++)
+    {
+        if (!calls[i].input_buffer || calls[i].input_buffer_size == 0)
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        if (!oe_is_outside_enclave(
+                calls[i].input_buffer, calls[i].input_buffer_size))
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        if (calls[i].output_buffer_size &&
+            (!calls[i].output_buffer ||
+             !oe_is_outside_enclave(
+                 calls[i].output_buffer, calls[i].output_buffer_size)))
+            OE_RAISE(OE_INVALID_PARAMETER);
+    }
+
+    OE_CHECK(oe_safe_mul_sizet(
+        num_calls, sizeof(oe_call_host_function_args_t), &host_calls_size));
+    OE_CHECK(oe_safe_add_sizet(
+        host_calls_size, sizeof(oe_call_host_functions_args_t), &buffer_size));
+
+    if (!(buffer = oe_ecall_context_get_ocall_buffer(buffer_size)))
+    {
+        if (!(buffer = oe_host_heap_allocate(buffer_size)))
+        {
+            /* Fail if the enclave is crashing. */
+            OE_CHECK(__oe_enclave_status);
+            OE_RAISE(OE_OUT_OF_MEMORY);
+        }
+        buffer_is_host_allocated = true;
+    }
+
+    args = (oe_call_host_functions_args_t*)buffer;
+    host_calls = (oe_call_host_function_args_t*)(args + 1);
+
+    for (size_t i = 0; i < num_calls; i++)
+    {
+        host_calls[i].function_id = calls[i].function_id;
+        host_calls[i].input_buffer = calls[i].input_buffer;
+        host_calls[i].input_buffer_size = calls[i].input_buffer_size;
+        host_calls[i].output_buffer = calls[i].output_buffer;
+        host_calls[i].output_buffer_size = calls[i].output_buffer_size;
+        host_calls[i].output_bytes_written = 0;
+        host_calls[i].result = OE_UNEXPECTED;
+    }
+
+    args->calls = host_calls;
+    args->num_calls = num_calls;
+
+    OE_CHECK(oe_ocall(OE_OCALL_CALL_HOST_FUNCTIONS, (uint64_t)args, NULL));
+
+    // Copy the results back. They are host-provided, so reject sizes that do
+    // not fit the output buffers.
+    for (size_t i = 0; i < num_calls; i++)
+    {
+        oe_result_t call_result = host_calls[i].result;
+        size_t output_bytes_written = host_calls[i].output_bytes_written;
+
+        if (call_result == OE_OK &&
+            output_bytes_written > calls[i].output_buffer_size)
+            call_result = OE_UNEXPECTED;
+
+        calls[i].result = call_result;
+        calls[i].output_bytes_written =
+            (call_result == OE_OK) ? output_bytes_written : 0;
+    }
+
+    result = OE_OK;
+
+done:
+    if (buffer_is_host_allocated)
+        oe_host_free(buffer);
+
+    return result;
+}
+
 /*
 **==============================================================================
 **
@@ -5,6 +5,7 @@
 #include <openenclave/enclave.h>
 #include <openenclave/internal/sgx/ecall_context.h>
 #include <openenclave/internal/sgx/td.h>
+#include "../hostheap.h"
 #include "td.h"
 
 /**
@@ -47,6 +48,30 @@ void* oe_ecall_context_get_ocall_buffer(uint64_t size)
     return NULL;
 }
 
+/**
+ * Get the host thread making the current ECALL, or zero if no ecall context
+ * has been passed in.
+ */
+uint64_t oe_ecall_context_get_host_thread(void)
+{
+    oe_ecall_context_t* ecall_context = _get_ecall_context();
+    return ecall_context ? ecall_context->host_thread : 0;
+}
+
+/**
+ * Record in the ecall context an ocall that did not fit in its buffer.
+ */
+static void _record_ocall_buffer_miss(uint64_t size)
+{
+    oe_ecall_context_t* ecall_context = _get_ecall_context();
+    if (ecall_context)
+    {
+        ecall_context->ocall_buffer_misses++;
+        if (ecall_context->ocall_buffer_miss_size < size)
+            ecall_context->ocall_buffer_miss_size = size;
+    }
+}
+
 // Function used by oeedger8r for allocating ocall buffers.
 void* oe_allocate_ocall_buffer(size_t size)
 {
@@ -58,8 +83,13 @@ void* oe_allocate_ocall_buffer(size_t size)
         return buffer;
     }
 
-    // Perform host allocation by making an ocall.
-    return oe_host_malloc(size);
+    // Report the miss so that the host can grow the buffer for the next
+    // ECALLs of this thread.
+    _record_ocall_buffer_miss(size);
+
+    // Allocate from the host heap, or perform host allocation by making an
+    // ocall.
+    return oe_host_heap_allocate(size);
 }
 
 // Function used by oeedger8r for freeing ocall buffers.
@@ -85,7 +115,7 @@ void oe_free_ocall_buffer(void* buffer)
 
 void* oe_allocate_arena(size_t capacity)
 {
-    return oe_host_malloc(capacity);
+    return oe_host_heap_allocate(capacity);
 }
 
 void oe_deallocate_arena(void* buffer)
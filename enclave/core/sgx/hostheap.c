@@ -0,0 +1,491 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "../hostheap.h"
+#include <openenclave/advanced/allocator.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/thread.h>
+
+/*
+**==============================================================================
+**
+** Host heap
+**
+**     Serves the host memory the SDK allocates for its own use (OCALL
+**     buffers, shared memory arenas) from chunks of host memory that are each
+**     obtained with a single OCALL, so that most of these allocations and
+**     frees do not leave the enclave. The blocks are interior pointers into
+**     the chunks, so they are never handed to the host to free: memory
+**     returned by oe_host_malloc() still comes from the host's malloc().
+**
+**     Each chunk is divided into pages. A page is either free, holds blocks
+**     of a single size class (a power of two smaller than the page), or is
+**     part of a run of pages holding a single larger allocation. Allocations
+**     larger than a chunk are left to the host.
+**
+**     All the metadata (the chunk addresses, the page states and the block
+**     bitmaps) is kept in enclave memory. The host can change the contents
+**     of the blocks, but cannot make the heap return overlapping ranges or
+**     ranges that are not outside the enclave.
+**
+**     The chunks are returned to the host when the enclave is terminated.
+**     The heap then stops serving allocations, and freeing a block of a
+**     returned chunk does nothing.
+**
+**==============================================================================
+*/
+
+#define OE_HOST_HEAP_PAGE_SHIFT 16
+#define OE_HOST_HEAP_PAGE_SIZE ((size_t)1 << OE_HOST_HEAP_PAGE_SHIFT)
+#define OE_HOST_HEAP_PAGES_PER_CHUNK 64
+#define OE_HOST_HEAP_CHUNK_SIZE \
+    (OE_HOST_HEAP_PAGE_SIZE * OE_HOST_HEAP_PAGES_PER_CHUNK)
+#define OE_HOST_HEAP_MAX_CHUNKS 64
+
+/* Size classes range from 64 bytes to half a page */
+#define OE_HOST_HEAP_MIN_BLOCK_SHIFT 6
+#define OE_HOST_HEAP_NUM_CLASSES \
+    (OE_HOST_HEAP_PAGE_SHIFT - OE_HOST_HEAP_MIN_BLOCK_SHIFT)
+#define OE_HOST_HEAP_MAX_BLOCK_SIZE (OE_HOST_HEAP_PAGE_SIZE / 2)
+#define OE_HOST_HEAP_BITMAP_WORDS \
+    ((OE_HOST_HEAP_PAGE_SIZE >> OE_HOST_HEAP_MIN_BLOCK_SHIFT) / 64)
+
+/* Page states. A page holding blocks of class c has the state
+ * _PAGE_BLOCKS + c. */
+#define _PAGE_FREE 0
+#define _PAGE_RUN 1
+#define _PAGE_RUN_TAIL 2
+#define _PAGE_BLOCKS 3
+
+typedef struct _host_heap_page
+{
+    uint32_t state;
+
+    /* The number of pages of a run, or the number of free blocks of a page
+     * holding blocks */
+    uint32_t count;
+
+    /* The pages of the same class that have free blocks */
+    struct _host_heap_page* prev;
+    struct _host_heap_page* next;
+
+    /* The blocks in use */
+    uint64_t bitmap[OE_HOST_HEAP_BITMAP_WORDS];
+} host_heap_page_t;
+
+typedef struct _host_heap_chunk
+{
+    uint8_t* base;
+    size_t free_pages;
+    host_heap_page_t* pages;
+} host_heap_chunk_t;
+
+static host_heap_chunk_t _chunks[OE_HOST_HEAP_MAX_CHUNKS];
+static size_t _num_chunks;
+static host_heap_page_t* _classes[OE_HOST_HEAP_NUM_CLASSES];
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+static bool _closed;
+
+static size_t _block_size(size_t cls)
+{
+    return (size_t)1 << (cls + OE_HOST_HEAP_MIN_BLOCK_SHIFT);
+}
+
+static size_t _num_blocks(size_t cls)
+{
+    return OE_HOST_HEAP_PAGE_SIZE >> (cls + OE_HOST_HEAP_MIN_BLOCK_SHIFT);
+}
+
+static size_t _size_class(size_t size)
+{
+    size_t shift = OE_HOST_HEAP_MIN_BLOCK_SHIFT;
+
+    while (((size_t)1 << shift) < size)
+        shift++;
+
+    return shift - OE_HOST_HEAP_MIN_BLOCK_SHIFT;
+}
+
+static uint8_t* _page_address(host_heap_chunk_t* chunk, host_heap_page_t* page)
+{
+    return chunk->base +
+           (size_t)(page - chunk->pages) * OE_HOST_HEAP_PAGE_SIZE;
+}
+
+static void _push_page(size_t cls, host_heap_page_t* page)
+{
+    page->prev = NULL;
+    page->next = _classes[cls];
+    if (page->next)
+        page->next->prev = page;
+    _classes[cls] = page;
+}
+
+static void _remove_page(size_t cls, host_heap_page_t* page)
+{
+    if (page->prev)
+        page->prev->next = page->next;
+    else
+        _classes[cls] = page->next;
+
+    if (page->next)
+        page->next->prev = page->prev;
+
+    page->prev = NULL;
+    page->next = NULL;
+}
+
+/* Obtain a new chunk from the host. Called with the lock held, which is
+ * released during the OCALL so that the other threads are not held up by it.
+ * If another thread added a chunk meanwhile, the new one is given back to the
+ * host and the caller looks for free pages again. */
+static bool _add_chunk(void)
+{
+    host_heap_chunk_t* chunk;
+    size_t num_chunks = _num_chunks;
+    uint64_t arg_out = 0;
+    host_heap_page_t* pages = NULL;
+
+    if (_closed || num_chunks == OE_HOST_HEAP_MAX_CHUNKS)
+        return false;
+
+    oe_spin_unlock(&_lock);
+
+    if (!(pages = oe_allocator_calloc(
+              OE_HOST_HEAP_PAGES_PER_CHUNK, sizeof(host_heap_page_t))))
+        goto failed;
+
+    if (oe_ocall(OE_OCALL_MALLOC, OE_HOST_HEAP_CHUNK_SIZE, &arg_out) != OE_OK ||
+        !arg_out)
+        goto failed;
+
+    if (!oe_is_outside_enclave((void*)arg_out, OE_HOST_HEAP_CHUNK_SIZE))
+        oe_abort();
+
+    oe_spin_lock(&_lock);
+
+    if (_closed || _num_chunks != num_chunks)
+    {
+        bool closed = _closed;
+
+        oe_spin_unlock(&_lock);
+        oe_ocall(OE_OCALL_FREE, arg_out, NULL);
+        oe_allocator_free(pages);
+        oe_spin_lock(&_lock);
+
+        return !closed;
+    }
+
+    chunk = &_chunks[_num_chunks++];
+    chunk->base = (uint8_t*)arg_out;
+    chunk->free_pages = OE_HOST_HEAP_PAGES_PER_CHUNK;
+    chunk->pages = pages;
+    return true;
+
+failed:
+    oe_allocator_free(pages);
+    oe_spin_lock(&_lock);
+    return false;
+}
+
+/* Find a run of free pages, adding a chunk if none has one */
+static host_heap_page_t* _allocate_pages(
+    size_t count,
+    host_heap_chunk_t** chunk_out)
+{
+    for (;;)
+    {
+        for (size_t i = 0; i < _num_chunks; i++)
+        {
+            host_heap_chunk_t* chunk = &_chunks[i];
+            size_t run = 0;
+
+            if (chunk->free_pages < count)
+                continue;
+
+            for (size_t j = 0; j < OE_HOST_HEAP_PAGES_PER_CHUNK; j++)
+            {
+                if (chunk->pages[j].state != _PAGE_FREE)
+                {
+                    run = 0;
+                    continue;
+                }
+
+                if (++run == count)
+                {
+                    host_heap_page_t* page = &chunk->pages[j + 1 - count];
+
+                    for (size_t k = 1; k < count; k++)
+                        page[k].state = _PAGE_RUN_TAIL;
+
+                    chunk->free_pages -= count;
+                    *chunk_out = chunk;
+                    return page;
+                }
+            }
+        }
+
+        if (!_add_chunk())
+            return NULL;
+    }
+}
+
+static void _free_pages(host_heap_chunk_t* chunk, host_heap_page_t* page)
+{
+    size_t count = page->state == _PAGE_RUN ? page->count : 1;
+
+    for (size_t k = 0; k < count; k++)
+    {
+        page[k].state = _PAGE_FREE;
+        page[k].count = 0;
+    }
+
+    chunk->free_pages += count;
+}
+
+static void* _allocate_block(size_t cls)
+{
+    host_heap_page_t* page = _classes[cls];
+    host_heap_chunk_t* chunk = NULL;
+    size_t num_blocks = _num_blocks(cls);
+
+    if (page)
+    {
+        /* Find the chunk of the page */
+        for (size_t i = 0; i < _num_chunks; i++)
+        {
+            if (page >= _chunks[i].pages &&
+                page < _chunks[i].pages + OE_HOST_HEAP_PAGES_PER_CHUNK)
+            {
+                chunk = &_chunks[i];
+                break;
+            }
+        }
+    }
+    else
+    {
+        if (!(page = _allocate_pages(1, &chunk)))
+            return NULL;
+
+        page->state = (uint32_t)(_PAGE_BLOCKS + cls);
+        page->count = (uint32_t)num_blocks;
+        for (size_t w = 0; w < OE_HOST_HEAP_BITMAP_WORDS; w++)
+            page->bitmap[w] = 0;
+        _push_page(cls, page);
+    }
+
+    for (size_t index = 0; index < num_blocks; index += 64)
+    {
+        uint64_t bits = ~page->bitmap[index / 64];
+
+        if (num_blocks - index < 64)
+            bits &= ((uint64_t)1 << (num_blocks - index)) - 1;
+
+        if (bits)
+        {
+            size_t bit = (size_t)__builtin_ctzll(bits);
+
+            page->bitmap[index / 64] |= (uint64_t)1 << bit;
+
+            if (--page->count == 0)
+                _remove_page(cls, page);
+
+            return _page_address(chunk, page) +
+                   (index + bit) * _block_size(cls);
+        }
+    }
+
+    /* A page on the list of its class always has a free block */
+    oe_abort();
+    return NULL;
+}
+
+/* Find the page holding ptr. Aborts if ptr is in a chunk but is not the
+ * address of an allocation, which means the enclave freed it twice or
+ * freed a pointer it did not allocate. */
+static host_heap_page_t* _find_page(
+    void* ptr,
+    host_heap_chunk_t** chunk_out,
+    size_t* index_out)
+{
+    uint8_t* p = (uint8_t*)ptr;
+
+    for (size_t i = 0; i < _num_chunks; i++)
+    {
+        host_heap_chunk_t* chunk = &_chunks[i];
+        host_heap_page_t* page;
+        size_t offset;
+
+        if (p < chunk->base || p >= chunk->base + OE_HOST_HEAP_CHUNK_SIZE)
+            continue;
+
+        offset = (size_t)(p - chunk->base);
+        page = &chunk->pages[offset / OE_HOST_HEAP_PAGE_SIZE];
+        offset %= OE_HOST_HEAP_PAGE_SIZE;
+
+        if (page->state == _PAGE_RUN && offset == 0)
+        {
+            *index_out = 0;
+        }
+        else if (page->state >= _PAGE_BLOCKS)
+        {
+            size_t cls = page->state - _PAGE_BLOCKS;
+            size_t index = offset / _block_size(cls);
+
+            if (offset % _block_size(cls) ||
+                !(page->bitmap[index / 64] & ((uint64_t)1 << (index % 64))))
+                oe_abort();
+
+            *index_out = index;
+        }
+        else
+            oe_abort();
+
+        *chunk_out = chunk;
+        return page;
+    }
+
+    return NULL;
+}
+
+void* oe_host_heap_malloc(size_t size)
+{
+    void* ptr = NULL;
+
+    if (size > OE_HOST_HEAP_CHUNK_SIZE)
+        return NULL;
+
+    oe_spin_lock(&_lock);
+
+    if (_closed)
+    {
+        /* The chunks were returned to the host */
+    }
+    else if (size <= OE_HOST_HEAP_MAX_BLOCK_SIZE)
+    {
+        ptr = _allocate_block(_size_class(size));
+    }
+    else
+    {
+        size_t count =
+            (size + OE_HOST_HEAP_PAGE_SIZE - 1) / OE_HOST_HEAP_PAGE_SIZE;
+        host_heap_chunk_t* chunk = NULL;
+        host_heap_page_t* page = _allocate_pages(count, &chunk);
+
+        if (page)
+        {
+            page->state = _PAGE_RUN;
+            page->count = (uint32_t)count;
+            ptr = _page_address(chunk, page);
+        }
+    }
+
+    oe_spin_unlock(&_lock);
+
+    if (ptr && !oe_is_outside_enclave(ptr, size ? size : 1))
+        oe_abort();
+
+    return ptr;
+}
+
+bool oe_host_heap_free(void* ptr)
+{
+    host_heap_chunk_t* chunk = NULL;
+    host_heap_page_t* page;
+    size_t index = 0;
+
+    if (!ptr)
+        return false;
+
+    oe_spin_lock(&_lock);
+
+    if (_closed)
+    {
+        /* The block went back to the host with its chunk */
+        for (size_t i = 0; i < _num_chunks; i++)
+        {
+            if ((uint8_t*)ptr >= _chunks[i].base &&
+                (uint8_t*)ptr < _chunks[i].base + OE_HOST_HEAP_CHUNK_SIZE)
+            {
+                oe_spin_unlock(&_lock);
+                return true;
+            }
+        }
+
+        page = NULL;
+    }
+    else if ((page = _find_page(ptr, &chunk, &index)))
+    {
+        if (page->state == _PAGE_RUN)
+        {
+            _free_pages(chunk, page);
+        }
+        else
+        {
+            size_t cls = page->state - _PAGE_BLOCKS;
+
+            page->bitmap[index / 64] &= ~((uint64_t)1 << (index % 64));
+
+            if (page->count++ == 0)
+                _push_page(cls, page);
+
+            /* Return the page once all its blocks are free */
+            if (page->count == _num_blocks(cls))
+            {
+                _remove_page(cls, page);
+                _free_pages(chunk, page);
+            }
+        }
+    }
+
+    oe_spin_unlock(&_lock);
+
+    return page != NULL;
+}
+
+size_t oe_host_heap_usable_size(void* ptr)
+{
+    host_heap_chunk_t* chunk = NULL;
+    host_heap_page_t* page = NULL;
+    size_t index = 0;
+    size_t size = 0;
+
+    if (!ptr)
+        return 0;
+
+    oe_spin_lock(&_lock);
+
+    if (!_closed && (page = _find_page(ptr, &chunk, &index)))
+    {
+        if (page->state == _PAGE_RUN)
+            size = page->count * OE_HOST_HEAP_PAGE_SIZE;
+        else
+            size = _block_size(page->state - _PAGE_BLOCKS);
+    }
+
+    oe_spin_unlock(&_lock);
+
+    return size;
+}
+
+void oe_host_heap_cleanup(void)
+{
+    oe_spin_lock(&_lock);
+
+    /* Keep the chunk addresses so that frees of their blocks are ignored */
+    for (size_t i = 0; !_closed && i < _num_chunks; i++)
+    {
+        oe_ocall(OE_OCALL_FREE, (uint64_t)_chunks[i].base, NULL);
+        oe_allocator_free(_chunks[i].pages);
+        _chunks[i].free_pages = 0;
+        _chunks[i].pages = NULL;
+    }
+
+    _closed = true;
+
+    for (size_t i = 0; i < OE_HOST_HEAP_NUM_CLASSES; i++)
+        _classes[i] = NULL;
+
+    oe_spin_unlock(&_lock);
+}
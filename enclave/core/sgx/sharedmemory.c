@@ -0,0 +1,220 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/string.h>
+#include <openenclave/edger8r/enclave.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/safemath.h>
+#include <openenclave/internal/thread.h>
+#include "platform_t.h"
+
+/*
+**==============================================================================
+**
+** Shared memory regions
+**
+**     Regions of host memory registered by the host with
+**     oe_register_shared_memory(). The address and size of each region are
+**     checked once, when the region is registered, and are kept in enclave
+**     memory: accesses are only checked against the bounds of the region.
+**
+**     A region identifier holds the index of the region in the table in its
+**     low bits and a generation count in its high bits, so that the
+**     identifier of an unregistered region does not match a region
+**     registered later in the same slot.
+**
+**==============================================================================
+*/
+
+#define OE_MAX_SHARED_MEMORY_REGIONS 64
+#define OE_SHARED_MEMORY_INDEX_BITS 8
+
+typedef struct _shared_memory_region
+{
+    /* 0 if the slot is free */
+    uint64_t id;
+    uint8_t* address;
+    size_t size;
+} shared_memory_region_t;
+
+static shared_memory_region_t _regions[OE_MAX_SHARED_MEMORY_REGIONS];
+static uint64_t _generation;
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+
+static size_t _region_index(uint64_t region_id)
+{
+    return (size_t)(
+        region_id & ((1ULL << OE_SHARED_MEMORY_INDEX_BITS) - 1));
+}
+
+static oe_result_t _find_region(
+    uint64_t region_id,
+    uint8_t** address,
+    size_t* size)
+{
+    oe_result_t result = OE_NOT_FOUND;
+    size_t index = _region_index(region_id);
+
+    if (region_id == 0 || index >= OE_MAX_SHARED_MEMORY_REGIONS)
+        return OE_NOT_FOUND;
+
+    oe_spin_lock(&_lock);
+
+    if (_regions[index].id == region_id)
+    {
+        *address = _regions[index].address;
+        *size = _regions[index].size;
+        result = OE_OK;
+    }
+
+    oe_spin_unlock(&_lock);
+
+    return result;
+}
+
+oe_result_t oe_sgx_register_shared_memory_ecall(
+    void* address,
+    size_t size,
+    uint64_t* region_id)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t index;
+
+    if (!address || !size || !region_id)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!oe_is_outside_enclave(address, size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Accesses to the region are only checked against its bounds from now
+     * on: make sure none of them runs speculatively before this check. */
+    oe_lfence();
+
+    oe_spin_lock(&_lock);
+
+    for (index = 0; index < OE_MAX_SHARED_MEMORY_REGIONS; index++)
+    {
+        if (_regions[index].id == 0)
+        {
+            _regions[index].id =
+                (++_generation << OE_SHARED_MEMORY_INDEX_BITS) | index;
+            _regions[index].address = (uint8_t*)address;
+            _regions[index].size = size;
+            *region_id = _regions[index].id;
+            break;
+        }
+    }
+
+    oe_spin_unlock(&_lock);
+
+    if (index == OE_MAX_SHARED_MEMORY_REGIONS)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_sgx_unregister_shared_memory_ecall(uint64_t region_id)
+{
+    oe_result_t result = OE_NOT_FOUND;
+    size_t index = _region_index(region_id);
+
+    if (region_id == 0 || index >= OE_MAX_SHARED_MEMORY_REGIONS)
+        OE_RAISE(OE_NOT_FOUND);
+
+    oe_spin_lock(&_lock);
+
+    if (_regions[index].id == region_id)
+    {
+        _regions[index].id = 0;
+        _regions[index].address = NULL;
+        _regions[index].size = 0;
+        result = OE_OK;
+    }
+
+    oe_spin_unlock(&_lock);
+
+done:
+    return result;
+}
+
+oe_result_t oe_shared_memory_read(
+    uint64_t region_id,
+    size_t offset,
+    void* buffer,
+    size_t size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t* address = NULL;
+    size_t region_size = 0;
+    size_t end = 0;
+
+    if (!buffer && size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_find_region(region_id, &address, &region_size));
+
+    if (oe_safe_add_sizet(offset, size, &end) != OE_OK || end > region_size)
+        OE_RAISE(OE_OUT_OF_BOUNDS);
+
+    if (size)
+        memcpy(buffer, address + offset, size);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_shared_memory_write(
+    uint64_t region_id,
+    size_t offset,
+    const void* buffer,
+    size_t size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t* address = NULL;
+    size_t region_size = 0;
+    size_t end = 0;
+
+    if (!buffer && size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_find_region(region_id, &address, &region_size));
+
+    if (oe_safe_add_sizet(offset, size, &end) != OE_OK || end > region_size)
+        OE_RAISE(OE_OUT_OF_BOUNDS);
+
+    if (size)
+        memcpy(address + offset, buffer, size);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_shared_memory_get(
+    uint64_t region_id,
+    void** address,
+    size_t* size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t* region_address = NULL;
+    size_t region_size = 0;
+
+    if (!address || !size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_find_region(region_id, &region_address, &region_size));
+
+    *address = region_address;
+    *size = region_size;
+    result = OE_OK;
+
+done:
+    return result;
+}
@@ -19,6 +19,15 @@ static size_t _host_worker_count = 0;
 // The array of host worker contexts. Initialized by host through ECALL
 static oe_host_worker_context_t* _host_worker_contexts = NULL;
 
+// The home worker of the calling thread plus one, or 0 until it is assigned.
+static __thread size_t _home_worker;
+
+// State of the calling thread's pseudo-random worker selection.
+static __thread uint64_t _random_state;
+
+// Ticket used to assign home workers round-robin.
+static size_t _next_home_worker = 0;
+
 // Flag to denote if switchless calls have already been initialized.
 static bool _is_switchless_initialized = false;
 
@@ -40,6 +49,8 @@ oe_result_t _oe_sgx_wake_switchless_worker_ocall(
     oe_host_worker_context_t* context);
 oe_result_t _oe_sgx_sleep_switchless_worker_ocall(
     oe_enclave_worker_context_t* context);
+oe_result_t _oe_sgx_wake_switchless_caller_ocall(
+    oe_enclave_worker_context_t* context);
 
 /**
  * Make the following OCALLs weak to support the system EDL opt-in.
@@ -68,6 +79,16 @@ OE_WEAK_ALIAS(
     _oe_sgx_sleep_switchless_worker_ocall,
     oe_sgx_sleep_switchless_worker_ocall);
 
+oe_result_t _oe_sgx_wake_switchless_caller_ocall(
+    oe_enclave_worker_context_t* context)
+{
+    OE_UNUSED(context);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(
+    _oe_sgx_wake_switchless_caller_ocall,
+    oe_sgx_wake_switchless_caller_ocall);
+
 /*
 **==============================================================================
 **
@@ -77,7 +98,7 @@ OE_WEAK_ALIAS(
 **
 **==============================================================================
 */
-bool oe_is_switchless_initialized()
+bool oe_is_switchless_initialized(void)
 {
     bool is_initialized;
 
@@ -142,83 +163,307 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** _enqueue_switchless_ocall()
+**
+**  Append args to the request ring of the given host worker. The ring is a
+**  bounded multi-producer queue in the style of Vyukov's MPMC queue: each slot
+**  carries a sequence number that tells the producer holding ticket t that
+**  the slot is free (sequence == t) and tells the host worker that the slot
+**  is filled (sequence == t + 1).
+**
+**  The ring lives in host memory. A misbehaving host can only cause the
+**  enqueue to fail or a call to never complete; the number of attempts is
+**  bounded so that a corrupted ring cannot make the enclave thread spin here
+**  forever.
+**
+**==============================================================================
+*/
+static bool _enqueue_switchless_ocall(
+    oe_host_worker_context_t* context,
+    oe_call_host_function_args_t* args)
+{
+    uint64_t tail = __atomic_load_n(&context->ring_tail, __ATOMIC_RELAXED);
+
+    for (size_t attempts = 0; attempts < 2 * OE_SWITCHLESS_RING_SIZE;
+         attempts++)
+    {
+        oe_switchless_call_slot_t* slot =
+            &context->ring[tail & (OE_SWITCHLESS_RING_SIZE - 1)];
+        uint64_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)(sequence - tail);
+
+        if (diff == 0)
+        {
+            // The slot is free for this ticket. Claim the ticket. On failure,
+            // tail is reloaded with the current value and we retry.
+            bool weak = false;
+            if (__atomic_compare_exchange_n(
+                    &context->ring_tail,
+                    &tail,
+                    tail + 1,
+                    weak,
+                    __ATOMIC_ACQ_REL,
+                    __ATOMIC_RELAXED))
+            {
+                slot->call_arg = args;
+
+                // Publish the slot to the host worker.
+                __atomic_store_n(&slot->sequence, tail + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The slot still holds a request from the previous lap. The ring
+            // is full.
+            return false;
+        }
+        else
+        {
+            // Another producer claimed the ticket. Catch up with the tail.
+            tail = __atomic_load_n(&context->ring_tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    return false;
+}
+
+/*
+**==============================================================================
+**
+** _get_queue_depth()
+**
+**  Return the number of calls in the request ring of a host worker. The slot
+**  of the call that is being handled is released only after the call
+**  completes, so a busy worker never looks idle.
+**
+**==============================================================================
+*/
+static uint64_t _get_queue_depth(oe_host_worker_context_t* context)
+{
+    return __atomic_load_n(&context->ring_tail, __ATOMIC_RELAXED) -
+           __atomic_load_n(&context->ring_head, __ATOMIC_RELAXED);
+}
+
+/*
+**==============================================================================
+**
+** _is_worker_active()
+**
+**  Workers that are not active are parked by the host's elastic pool
+**  management; calls are posted to active workers only.
+**
+**==============================================================================
+*/
+static bool _is_worker_active(oe_host_worker_context_t* context)
+{
+    return __atomic_load_n(&context->is_active, __ATOMIC_ACQUIRE);
+}
+
+/*
+**==============================================================================
+**
+** _get_active_worker_count()
+**
+**  The host activates and retires the workers of an elastic pool in order, so
+**  the active workers are the first ones.
+**
+**==============================================================================
+*/
+static size_t _get_active_worker_count(void)
+{
+    size_t count = 0;
+
+    while (count < _host_worker_count &&
+           _is_worker_active(&_host_worker_contexts[count]))
+        count++;
+
+    return count;
+}
+
+/*
+**==============================================================================
+**
+** _get_home_worker()
+**
+**  Return the index of the calling thread's home worker among count workers.
+**  Threads are assigned home workers round-robin the first time they post a
+**  call, so that concurrent callers start on different workers.
+**
+**==============================================================================
+*/
+static size_t _get_home_worker(size_t count)
+{
+    if (_home_worker == 0)
+        _home_worker =
+            __atomic_add_fetch(&_next_home_worker, 1, __ATOMIC_RELAXED);
+
+    return (_home_worker - 1) % count;
+}
+
+/*
+**==============================================================================
+**
+** _get_random_worker()
+**
+**  Return the index of a pseudo-randomly chosen worker among count workers.
+**  The generator is a per-thread xorshift, seeded with the address of the
+**  thread's state.
+**
+**==============================================================================
+*/
+static size_t _get_random_worker(size_t count)
+{
+    uint64_t x = _random_state;
+
+    if (x == 0)
+        x = (uint64_t)&_random_state | 1;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    _random_state = x;
+
+    return (size_t)(x % count);
+}
+
+/*
+**==============================================================================
+**
+** _wake_host_worker()
+**
+**==============================================================================
+*/
+static void _wake_host_worker(oe_host_worker_context_t* context)
+{
+    // The worker thread has been handed this switchless call. Determine if it
+    // needs to be woken up or not.
+    //
+    // If event is 0, it means that it has gone to sleep. Wake it by
+    // making an ocall (oe_sgx_wake_switchless_worker_ocall).
+    // Note: it is important to use an atomic cas operation to set
+    // the value to 1 before making the ocall. Setting the value to
+    // 1 prevents the host worker from simulataneously going to
+    // sleep. If instead, just a compare operation is used to
+    // determine if the host thread is sleeping or not, the host
+    // thread could go to sleep after the enclave has determined
+    // that the host is not sleeping, causing a deadlock.
+    //
+    // If event is 1, that indicates a pending wake notification.
+    int32_t oldval = 0;
+    int32_t newval = 1;
+    // Weak operation could sporadically fail.
+    // We need a strong operation.
+    bool weak = false;
+    if (__atomic_compare_exchange_n(
+            &context->event,
+            &oldval,
+            newval,
+            weak,
+            __ATOMIC_ACQ_REL,
+            __ATOMIC_ACQUIRE))
+    {
+        // The pevious value of the event was 0 which means that the
+        // worker was previously sleeping.
+        // Wake it via an ocall.
+        oe_sgx_wake_switchless_worker_ocall(context);
+    }
+}
+
 /*
 **==============================================================================
 **
 ** oe_post_switchless_ocall()
 **
-**  Post the function call (wrapped in args) to a free host worker thread
-**  by writing to its context.
+**  Post the function call (wrapped in args) to a host worker thread by
+**  appending it to the worker's request ring. The two candidates are the
+**  calling thread's home worker and a randomly chosen one ("power of two
+**  choices"). The call goes to an idle worker whenever there is one: first
+**  to an idle candidate, then to any other idle active worker, scanning from
+**  the home worker. Only when every active worker is busy is the call queued
+**  behind the less loaded candidate, or else on any other worker with room.
+**  Spreading the callers spreads the traffic on the ring tails over the
+**  workers. A miss is counted on the home worker so that the host can grow an
+**  elastic pool.
 **
 **==============================================================================
 */
 oe_result_t oe_post_switchless_ocall(oe_call_host_function_args_t* args)
 {
-    oe_result_t result = OE_UNEXPECTED;
+    size_t num_active = 0;
+    size_t home = 0;
+    oe_host_worker_context_t* first_context = NULL;
+    oe_host_worker_context_t* second_context = NULL;
 
     OE_ATOMIC_MEMORY_BARRIER_RELEASE();
     args->result = __OE_RESULT_MAX; // Means the call hasn't been processed.
 
-    // Cycle through the worker contexts until we find a free worker.
-    size_t tries = _host_worker_count;
-    while (tries--)
+    if ((num_active = _get_active_worker_count()) == 0)
+        return OE_CONTEXT_SWITCHLESS_OCALL_MISSED;
+
+    home = _get_home_worker(num_active);
+    first_context = &_host_worker_contexts[home];
+    second_context = &_host_worker_contexts[_get_random_worker(num_active)];
+
+    if (_get_queue_depth(second_context) < _get_queue_depth(first_context))
+    {
+        oe_host_worker_context_t* context = first_context;
+        first_context = second_context;
+        second_context = context;
+    }
+
+    /* Queueing behind a busy worker waits for its calls, prefer idle ones */
+    if (_get_queue_depth(first_context) != 0)
     {
-        // Check if the worker's slot is free.
-        if (_host_worker_contexts[tries].call_arg == NULL)
+        for (size_t i = 1; i < num_active; i++)
         {
-            // Try to atomically grab the slot by placing args in the slot.
-            // If the atomic operation was successful, then the worker thread
-            // will execute this switchless ocall. If the atomic operation
-            // failed, this means that the slot was grabbed by another
-            // switchless ocall and therefore, we must scan for another worker
-            // thread with a free slot.
-            if (oe_atomic_compare_and_swap_ptr(
-                    (void* volatile*)&_host_worker_contexts[tries].call_arg,
-                    NULL,
-                    args))
-            {
-                // The worker thread has been marked to execute this switchless
-                // call. Determine if it needs to be woken up or not.
-                //
-                // If event is 0, it means that it has gone to sleep. Wake it by
-                // making an ocall (oe_sgx_wake_switchless_worker_ocall).
-                // Note: it is important to use an atomic cas operation to set
-                // the value to 1 before making the ocall. Setting the value to
-                // 1 prevents the host worker from simulataneously going to
-                // sleep. If instead, just a compare operation is used to
-                // determine if the host thread is sleeping or not, the host
-                // thread could go to sleep after the enclave has determined
-                // that the host is not sleeping, causing a deadlock.
-                //
-                // If event is 1, that indicates a pending wake notification.
-                int32_t oldval = 0;
-                int32_t newval = 1;
-                // Weak operation could sporadically fail.
-                // We need a strong operation.
-                bool weak = false;
-                if (__atomic_compare_exchange_n(
-                        &_host_worker_contexts[tries].event,
-                        &oldval,
-                        newval,
-                        weak,
-                        __ATOMIC_ACQ_REL,
-                        __ATOMIC_ACQUIRE))
-                {
-                    // The pevious value of the event was 0 which means that the
-                    // worker was previously sleeping.
-                    // Wake it via an ocall.
-                    oe_sgx_wake_switchless_worker_ocall(
-                        &_host_worker_contexts[tries]);
-                }
+            oe_host_worker_context_t* context =
+                &_host_worker_contexts[(home + i) % num_active];
 
+            if (_get_queue_depth(context) == 0 &&
+                _enqueue_switchless_ocall(context, args))
+            {
+                _wake_host_worker(context);
                 return OE_OK;
             }
         }
     }
 
-    result = OE_CONTEXT_SWITCHLESS_OCALL_MISSED;
+    if (_enqueue_switchless_ocall(first_context, args))
+    {
+        _wake_host_worker(first_context);
+        return OE_OK;
+    }
+
+    if (second_context != first_context &&
+        _enqueue_switchless_ocall(second_context, args))
+    {
+        _wake_host_worker(second_context);
+        return OE_OK;
+    }
 
-    return result;
+    for (size_t i = 1; i < num_active; i++)
+    {
+        oe_host_worker_context_t* context =
+            &_host_worker_contexts[(home + i) % num_active];
+
+        if (context == first_context || context == second_context)
+            continue;
+
+        if (_enqueue_switchless_ocall(context, args))
+        {
+            _wake_host_worker(context);
+            return OE_OK;
+        }
+    }
+
+    __atomic_fetch_add(
+        &_host_worker_contexts[home].missed_count, 1, __ATOMIC_RELAXED);
+
+    return OE_CONTEXT_SWITCHLESS_OCALL_MISSED;
 }
 
 /*
@@ -247,6 +492,192 @@ oe_result_t oe_switchless_call_host_function(
         true /* switchless */);
 }
 
+/*
+**==============================================================================
+**
+** Asynchronous switchless ocalls
+**
+** The call descriptor (args) and the marshaling buffers of an asynchronous
+** call live in the thread's arena. The arena is pinned while the call is
+** outstanding so that the oe_arena_free_all() performed after each
+** synchronous switchless ocall does not recycle them.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_switchless_call_host_function_async(
+    size_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size,
+    oe_switchless_call_handle_t* handle)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_host_function_args_t* args = NULL;
+
+    if (handle)
+    {
+        handle->args = NULL;
+        handle->output_buffer_size = output_buffer_size;
+    }
+
+    if (!handle || !input_buffer || input_buffer_size == 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    args = (oe_call_host_function_args_t*)oe_arena_malloc(sizeof(*args));
+    if (args == NULL)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    args->function_id = function_id;
+    args->input_buffer = input_buffer;
+    args->input_buffer_size = input_buffer_size;
+    args->output_buffer = output_buffer;
+    args->output_buffer_size = output_buffer_size;
+    args->output_bytes_written = 0;
+    args->result = OE_UNEXPECTED;
+
+    oe_arena_pin();
+    handle->args = args;
+
+    if (oe_is_switchless_initialized())
+    {
+        result = oe_post_switchless_ocall(args);
+        if (result == OE_OK)
+            goto done;
+
+        if (result != OE_CONTEXT_SWITCHLESS_OCALL_MISSED)
+            OE_RAISE(result);
+    }
+
+    // Fall back to a synchronous regular OCALL. The handle completes
+    // immediately.
+    OE_CHECK(oe_ocall(OE_OCALL_CALL_HOST_FUNCTION, (uint64_t)args, NULL));
+    result = OE_OK;
+
+done:
+    if (result != OE_OK && handle && handle->args)
+    {
+        handle->args = NULL;
+        oe_arena_unpin();
+    }
+
+    return result;
+}
+
+/* Return OE_BUSY if the call is in progress, its status otherwise. The
+ * status is read from host memory once. */
+static oe_result_t _get_switchless_call_status(
+    oe_call_host_function_args_t* args)
+{
+    oe_result_t result = __atomic_load_n(&args->result, __ATOMIC_ACQUIRE);
+    return (result == __OE_RESULT_MAX) ? OE_BUSY : result;
+}
+
+/* Consume a completed handle. The host writes output_bytes_written, so it is
+ * read once and checked against the size of the output buffer, which the
+ * handle keeps in enclave memory. */
+static oe_result_t _complete_switchless_call(
+    oe_switchless_call_handle_t* handle,
+    oe_result_t status,
+    size_t* output_bytes_written)
+{
+    oe_call_host_function_args_t* args =
+        (oe_call_host_function_args_t*)handle->args;
+    size_t bytes_written = 0;
+
+    if (status == OE_OK)
+    {
+        bytes_written =
+            __atomic_load_n(&args->output_bytes_written, __ATOMIC_RELAXED);
+
+        if (bytes_written > handle->output_buffer_size)
+            status = OE_UNEXPECTED;
+    }
+
+    if (status == OE_OK && output_bytes_written)
+        *output_bytes_written = bytes_written;
+
+    handle->args = NULL;
+    oe_arena_unpin();
+
+    return status;
+}
+
+oe_result_t oe_switchless_call_poll(
+    oe_switchless_call_handle_t* handle,
+    size_t* output_bytes_written)
+{
+    oe_result_t status;
+
+    if (!handle || !handle->args)
+        return OE_INVALID_PARAMETER;
+
+    if ((status = _get_switchless_call_status(handle->args)) == OE_BUSY)
+        return OE_BUSY;
+
+    return _complete_switchless_call(handle, status, output_bytes_written);
+}
+
+oe_result_t oe_switchless_call_wait(
+    oe_switchless_call_handle_t* handle,
+    size_t* output_bytes_written)
+{
+    oe_result_t status;
+
+    if (!handle || !handle->args)
+        return OE_INVALID_PARAMETER;
+
+    // Wait until args.result is set by the host worker.
+    while ((status = _get_switchless_call_status(handle->args)) == OE_BUSY)
+    {
+        /* Yield to CPU */
+        asm volatile("pause");
+    }
+
+    return _complete_switchless_call(handle, status, output_bytes_written);
+}
+
+oe_result_t oe_switchless_call_wait_any(
+    oe_switchless_call_handle_t* handles,
+    size_t count,
+    size_t* index,
+    size_t* output_bytes_written)
+{
+    bool has_pending_call = false;
+
+    if (!handles || !index)
+        return OE_INVALID_PARAMETER;
+
+    for (size_t i = 0; i < count; i++)
+        has_pending_call |= (handles[i].args != NULL);
+
+    if (!has_pending_call)
+        return OE_INVALID_PARAMETER;
+
+    while (true)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            oe_result_t status;
+
+            if (!handles[i].args)
+                continue;
+
+            status = _get_switchless_call_status(handles[i].args);
+            if (status != OE_BUSY)
+            {
+                *index = i;
+                return _complete_switchless_call(
+                    &handles[i], status, output_bytes_written);
+            }
+        }
+
+        /* Yield to CPU */
+        asm volatile("pause");
+    }
+}
+
 void oe_sgx_switchless_enclave_worker_thread_ecall(
     oe_enclave_worker_context_t* context)
 {
@@ -274,6 +705,23 @@ void oe_sgx_switchless_enclave_worker_thread_ecall(
             OE_ATOMIC_MEMORY_BARRIER_RELEASE();
             context->call_arg = NULL;
 
+            // If the host thread that posted the call ran out of spin budget,
+            // it registered the call in waiting_call and blocks until woken.
+            // The atomic operation orders the check after clearing the slot:
+            // either it sees the registration, or the host thread sees the
+            // cleared slot and does not block.
+            void* waiting_call = (void*)local_call_arg;
+            if (__atomic_compare_exchange_n(
+                    &context->waiting_call,
+                    &waiting_call,
+                    NULL,
+                    false,
+                    __ATOMIC_SEQ_CST,
+                    __ATOMIC_SEQ_CST))
+            {
+                oe_sgx_wake_switchless_caller_ocall(context);
+            }
+
             // Reset spin count for next message.
             context->total_spin_count += context->spin_count;
             context->spin_count = 0;
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "td.h"
+#include <openenclave/advanced/allocator.h>
 #include <openenclave/bits/sgx/sgxtypes.h>
 #include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
@@ -10,6 +11,7 @@
 #include <openenclave/internal/globals.h>
 #include <openenclave/internal/rdrand.h>
 #include <openenclave/internal/safecrt.h>
+#include <openenclave/internal/thread.h>
 #include <openenclave/internal/utils.h>
 #include "asmdefs.h"
 #include "thread.h"
@@ -196,3 +198,183 @@ bool td_initialized(oe_sgx_td_t* td)
 
     return false;
 }
+
+/*
+**==============================================================================
+**
+** oe_sgx_persistent_thread_locals
+**
+**     Whether the enclave keeps its thread-local storage across ECALLs. Set
+**     to true by OE_SET_ENCLAVE_SGX_PERSISTENT_THREAD_LOCALS(), which
+**     overrides this weak definition.
+**
+**==============================================================================
+*/
+
+OE_WEAK const bool oe_sgx_persistent_thread_locals = false;
+
+/*
+**==============================================================================
+**
+** td_register()
+**
+**     Record a td that keeps state across ECALLs, such as bound thread-local
+**     storage or an ECALL buffer, so that the state can be released when the
+**     enclave is terminated. Registering a td again has no effect.
+**
+**==============================================================================
+*/
+
+static oe_sgx_td_t* _tds[OE_SGX_MAX_TCS];
+static size_t _num_tds;
+static oe_spinlock_t _tds_lock = OE_SPINLOCK_INITIALIZER;
+
+void td_register(oe_sgx_td_t* td)
+{
+    oe_spin_lock(&_tds_lock);
+
+    for (size_t i = 0; i < _num_tds; i++)
+    {
+        if (_tds[i] == td)
+            goto done;
+    }
+
+    if (_num_tds < OE_SGX_MAX_TCS)
+        _tds[_num_tds++] = td;
+
+done:
+    oe_spin_unlock(&_tds_lock);
+}
+
+static size_t _get_registered_tds(oe_sgx_td_t* tds[OE_SGX_MAX_TCS])
+{
+    size_t num_tds;
+
+    oe_spin_lock(&_tds_lock);
+    num_tds = _num_tds;
+    memcpy(tds, _tds, num_tds * sizeof(oe_sgx_td_t*));
+    oe_spin_unlock(&_tds_lock);
+
+    return num_tds;
+}
+
+/*
+**==============================================================================
+**
+** td_bind_thread_locals()
+**
+**     Bind the thread-local storage of the TCS to the host thread making the
+**     outermost ECALL. If the storage was kept from an ECALL of another host
+**     thread, its thread-local and thread-specific values are destroyed and
+**     it is reinitialized, so that host threads never see the values of one
+**     another. This runs after the callsite is pushed since the destructors
+**     may make OCALLs.
+**
+**==============================================================================
+*/
+
+void td_bind_thread_locals(oe_sgx_td_t* td, uint64_t host_thread)
+{
+    if (td->thread_locals_bound &&
+        (host_thread == 0 || td->thread_locals_host_thread != host_thread))
+    {
+        oe_thread_destruct_specific();
+        oe_thread_local_cleanup(td);
+        oe_thread_local_init(td);
+    }
+
+    if (!td->thread_locals_bound)
+        td_register(td);
+
+    td->thread_locals_host_thread = host_thread;
+    td->thread_locals_bound = 1;
+}
+
+/*
+**==============================================================================
+**
+** td_release_all_thread_locals()
+**
+**     Destroy the thread-local and thread-specific values kept by every TCS,
+**     including the calling one. Called by the destructor ECALL before it
+**     checks for memory leaks, since TCSs that are not entered again would
+**     otherwise never release them. The destructors of the other TCSs run on
+**     the calling thread. TCSs that are inside an ECALL are skipped.
+**
+**==============================================================================
+*/
+
+void td_release_all_thread_locals(oe_sgx_td_t* current)
+{
+    oe_sgx_td_t* tds[OE_SGX_MAX_TCS];
+
+    /* The destructors may make OCALLs, so do not hold the lock */
+    size_t num_tds = _get_registered_tds(tds);
+
+    for (size_t i = 0; i < num_tds; i++)
+    {
+        oe_sgx_td_t* td = tds[i];
+
+        if (!td->thread_locals_bound || (td != current && td->depth != 0))
+            continue;
+
+        oe_thread_destruct_specific_td(td);
+
+        if (td == current)
+            oe_thread_local_cleanup(td);
+        else
+            oe_thread_local_release(td);
+
+        td->thread_locals_bound = 0;
+        td->thread_locals_reset = 0;
+    }
+}
+
+/*
+**==============================================================================
+**
+** td_release_all_ecall_buffers()
+**
+**     Free the buffers that oe_call_enclave_function() keeps in every TCS to
+**     unmarshal the arguments of ECALLs. Called by the destructor ECALL
+**     before the allocator is cleaned up. Buffers that are in use by an
+**     ECALL are skipped.
+**
+**==============================================================================
+*/
+
+void td_release_all_ecall_buffers(void)
+{
+    oe_sgx_td_t* tds[OE_SGX_MAX_TCS];
+    size_t num_tds = _get_registered_tds(tds);
+
+    for (size_t i = 0; i < num_tds; i++)
+    {
+        oe_sgx_td_t* td = tds[i];
+
+        if (td->ecall_buffer_in_use)
+            continue;
+
+        oe_allocator_free(td->ecall_buffer);
+        td->ecall_buffer = NULL;
+        td->ecall_buffer_size = 0;
+        td->ecall_buffer_dirty_size = 0;
+    }
+}
+
+/*
+**==============================================================================
+**
+** oe_reset_thread_locals()
+**
+**     Request that the thread-local storage of the calling thread be
+**     destroyed when the outermost ECALL returns (see td_clear()).
+**
+**==============================================================================
+*/
+
+oe_result_t oe_reset_thread_locals(void)
+{
+    oe_sgx_get_td()->thread_locals_reset = 1;
+    return OE_OK;
+}
@@ -77,6 +77,17 @@ void* td_to_tcs(const oe_sgx_td_t* td);
 
 bool td_initialized(oe_sgx_td_t* td);
 
+void td_bind_thread_locals(oe_sgx_td_t* td, uint64_t host_thread);
+
+void td_register(oe_sgx_td_t* td);
+
+void td_release_all_thread_locals(oe_sgx_td_t* current);
+
+void td_release_all_ecall_buffers(void);
+
+/* Defined by OE_SET_ENCLAVE_SGX_PERSISTENT_THREAD_LOCALS() */
+extern const bool oe_sgx_persistent_thread_locals;
+
 /*
 **==============================================================================
 **
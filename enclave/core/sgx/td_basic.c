@@ -110,7 +110,9 @@ void td_init(oe_sgx_td_t* td)
         /* List of callsites is initially empty */
         td->callsites = NULL;
 
-        oe_thread_local_init(td);
+        /* Keep the thread-local storage kept from the previous ECALLs */
+        if (!td->thread_locals_bound)
+            oe_thread_local_init(td);
     }
 }
 
@@ -122,6 +124,10 @@ void td_init(oe_sgx_td_t* td)
 **     Clear the oe_sgx_td_t. This is called when the ECALL depth falls to zero
 **     in td_pop_callsite().
 **
+**     Enclaves defined with OE_SET_ENCLAVE_SGX_PERSISTENT_THREAD_LOCALS()
+**     keep their thread-local storage and pthread_key values bound to the
+**     TCS, unless oe_reset_thread_locals() was called during the ECALL.
+**
 **==============================================================================
 */
 
@@ -130,11 +136,17 @@ void td_clear(oe_sgx_td_t* td)
     if (td->depth != 1)
         oe_abort();
 
-    // Release any pthread thread-local storage created using
-    // pthread_create_key.
-    oe_thread_destruct_specific();
+    if (!oe_sgx_persistent_thread_locals || td->thread_locals_reset)
+    {
+        // Release any pthread thread-local storage created using
+        // pthread_create_key.
+        oe_thread_destruct_specific();
+
+        oe_thread_local_cleanup(td);
 
-    oe_thread_local_cleanup(td);
+        td->thread_locals_bound = 0;
+        td->thread_locals_reset = 0;
+    }
 
     // The call sites and depth are cleaned up after the thread-local storage is
     // cleaned up since thread-local dynamic destructors could make ocalls.
@@ -920,12 +920,9 @@ void* oe_thread_getspecific(oe_thread_key_t key)
     return tsd_page[key];
 }
 
-void oe_thread_destruct_specific(void)
+static void _destruct_specific(void** tsd_page)
 {
-    void** tsd_page;
-
-    /* Get the thread-specific-data page for the current thread. */
-    if ((tsd_page = _get_tsd_page()))
+    if (tsd_page)
     {
         oe_spin_lock(&_lock);
         {
@@ -949,3 +946,14 @@ void oe_thread_destruct_specific(void)
         oe_spin_unlock(&_lock);
     }
 }
+
+void oe_thread_destruct_specific(void)
+{
+    /* Get the thread-specific-data page for the current thread. */
+    _destruct_specific(_get_tsd_page());
+}
+
+void oe_thread_destruct_specific_td(oe_sgx_td_t* td)
+{
+    _destruct_specific((void**)&td->base);
+}
@@ -4,9 +4,15 @@
 #ifndef _OE_CORE_THREAD_H_H
 #define _OE_CORE_THREAD_H_H
 
+#include <openenclave/internal/sgx/td.h>
+
 // This function is called when the enclave is finished with a thread (when
 // exiting). It invokes all thread-specific-data destructors for the current
 // thread.
 void oe_thread_destruct_specific(void);
 
+// Same as oe_thread_destruct_specific() for the given thread, which need not
+// be the current thread. The destructors run on the current thread.
+void oe_thread_destruct_specific_td(oe_sgx_td_t* td);
+
 #endif /* _OE_CORE_THREAD_H_H */
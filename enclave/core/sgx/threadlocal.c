@@ -391,11 +391,7 @@ void __cxa_thread_atexit(void (*destructor)(void*), void* object)
     td->tls_atexit_functions[td->num_tls_atexit_functions - 1] = item;
 }
 
-/**
- * Cleanup the thread-local section for a given thread.
- * This must be called *before* the td itself is cleaned up.
- */
-oe_result_t oe_thread_local_cleanup(oe_sgx_td_t* td)
+static void _thread_local_cleanup(oe_sgx_td_t* td, bool current_thread)
 {
     /* Call tls atexit functions in reverse order*/
     if (td->tls_atexit_functions)
@@ -416,10 +412,33 @@ oe_result_t oe_thread_local_cleanup(oe_sgx_td_t* td)
     uint8_t* fs = _get_fs_from_td(td);
     uint8_t* tls_start = _get_thread_local_data_start(td);
     // Invoke the cleanup function even when the thread-local data is empty
-    // (i.e., tls_start is NULL when tdata and tbss are zero).
-    oe_allocator_thread_cleanup();
+    // (i.e., tls_start is NULL when tdata and tbss are zero). It only applies
+    // to the current thread. The allocator locates the thread-local state of
+    // another thread by its offset from that of the current one.
+    if (current_thread)
+        oe_allocator_thread_cleanup();
+    else
+        oe_allocator_thread_release(fs - _get_fs_from_td(oe_sgx_get_td()));
     if (tls_start)
         oe_memset_s(tls_start, (uint64_t)(fs - tls_start), 0, 0);
+}
 
+/**
+ * Cleanup the thread-local section for a given thread.
+ * This must be called *before* the td itself is cleaned up.
+ */
+oe_result_t oe_thread_local_cleanup(oe_sgx_td_t* td)
+{
+    _thread_local_cleanup(td, true);
+    return OE_OK;
+}
+
+/**
+ * Cleanup the thread-local section of a thread that is not running, from
+ * another thread.
+ */
+oe_result_t oe_thread_local_release(oe_sgx_td_t* td)
+{
+    _thread_local_cleanup(td, false);
     return OE_OK;
 }
@@ -21,6 +21,13 @@ oe_result_t oe_thread_local_init(oe_sgx_td_t* td);
  */
 oe_result_t oe_thread_local_cleanup(oe_sgx_td_t* td);
 
+/**
+ * Cleanup the thread-local section of a thread that is not running, from
+ * another thread. Unlike oe_thread_local_cleanup(), the per-thread allocator
+ * state is not cleaned up.
+ */
+oe_result_t oe_thread_local_release(oe_sgx_td_t* td);
+
 OE_EXTERNC_END
 
 #endif // _OE_CORE_THREADLOCAL_H
@@ -0,0 +1,62 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/raise.h>
+#include "core_u.h"
+
+/**
+ * Declare the prototype of the following function to avoid the
+ * missing-prototypes warning.
+ */
+OE_UNUSED_FUNC oe_result_t _oe_get_allocator_stats_ecall(
+    oe_enclave_t* enclave,
+    oe_result_t* _retval,
+    void* stats,
+    size_t stats_size);
+
+/**
+ * Make the following ECALL weak to support the system EDL opt-in.
+ * When the user does not opt into (import) the EDL, the linker will pick
+ * the following default implementation. If the user opts into the EDL,
+ * the implemention (which is also weak) in the oeedger8r-generated code will
+ * be used. This behavior is guaranteed by the linker; i.e., the linker will
+ * pick the symbols defined in the object before those in the library.
+ */
+oe_result_t _oe_get_allocator_stats_ecall(
+    oe_enclave_t* enclave,
+    oe_result_t* _retval,
+    void* stats,
+    size_t stats_size)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(stats);
+    OE_UNUSED(stats_size);
+
+    if (_retval)
+        *_retval = OE_UNSUPPORTED;
+
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_get_allocator_stats_ecall, oe_get_allocator_stats_ecall);
+
+oe_result_t oe_get_allocator_stats(
+    oe_enclave_t* enclave,
+    oe_allocator_stats_t* stats)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t retval = OE_UNEXPECTED;
+
+    if (!enclave || !stats)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_get_allocator_stats_ecall(
+        enclave, &retval, stats, sizeof(*stats)));
+    OE_CHECK(retval);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
@@ -3,10 +3,86 @@
 
 #include <openenclave/host.h>
 #include <openenclave/internal/raise.h>
+#include <openenclave/internal/safemath.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "calls.h"
 #include "ecall_ids.h"
 
+/*
+**==============================================================================
+**
+** _call_enclave_function_inline()
+**
+** Call the enclave function specified by the given function-id, carrying its
+** input and output in the arguments of the ECALL.
+**
+**==============================================================================
+*/
+
+OE_STATIC_ASSERT(
+    OE_CALL_INLINE_BUFFER_ALIGNMENT % OE_EDGER8R_BUFFER_ALIGNMENT == 0);
+
+static bool _fits_inline(size_t input_buffer_size, size_t output_buffer_size)
+{
+    if (input_buffer_size > OE_CALL_INLINE_BUFFER_SIZE ||
+        output_buffer_size > OE_CALL_INLINE_BUFFER_SIZE)
+        return false;
+
+    return OE_CALL_INLINE_OUTPUT_OFFSET(input_buffer_size) <=
+           OE_CALL_INLINE_BUFFER_SIZE - output_buffer_size;
+}
+
+static oe_result_t _call_enclave_function_inline(
+    oe_enclave_t* enclave,
+    uint64_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size,
+    size_t* output_bytes_written)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_enclave_function_inline_args_t args;
+    size_t output_offset = OE_CALL_INLINE_OUTPUT_OFFSET(input_buffer_size);
+
+    /* Initialize the arguments, leaving the output area as is: the enclave
+     * clears it */
+    args.function_id = function_id;
+    args.input_buffer_size = input_buffer_size;
+    args.output_buffer_size = output_buffer_size;
+    args.output_bytes_written = 0;
+    args.result = OE_UNEXPECTED;
+    memcpy(args.buffer, input_buffer, input_buffer_size);
+
+    /* Perform the ECALL */
+    {
+        uint64_t arg_out = 0;
+
+        OE_CHECK(oe_ecall(
+            enclave,
+            OE_ECALL_CALL_ENCLAVE_FUNCTION_INLINE,
+            (uint64_t)&args,
+            &arg_out));
+        OE_CHECK((oe_result_t)arg_out);
+    }
+
+    /* Check the result */
+    OE_CHECK(args.result);
+
+    if (args.output_bytes_written > output_buffer_size)
+        OE_RAISE(OE_UNEXPECTED);
+
+    memcpy(
+        output_buffer, args.buffer + output_offset, args.output_bytes_written);
+    *output_bytes_written = args.output_bytes_written;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 /*
 **==============================================================================
 **
@@ -33,6 +109,21 @@ static oe_result_t _call_enclave_function_impl(
     if (!enclave)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    /* Small calls skip the separate marshaling buffers */
+    if (input_buffer && output_buffer &&
+        _fits_inline(input_buffer_size, output_buffer_size))
+    {
+        result = _call_enclave_function_inline(
+            enclave,
+            function_id,
+            input_buffer,
+            input_buffer_size,
+            output_buffer,
+            output_buffer_size,
+            output_bytes_written);
+        goto done;
+    }
+
     /* Initialize the call_enclave_args structure */
     {
         args.function_id = function_id;
@@ -109,3 +200,82 @@ oe_result_t oe_call_enclave_function(
 done:
     return result;
 }
+
+/*
+**==============================================================================
+**
+** oe_call_enclave_functions()
+**
+** Call a batch of enclave functions with a single ECALL. The function ids are
+** resolved up front so that a bad name fails the whole batch before entering
+** the enclave.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_call_enclave_functions(
+    oe_enclave_t* enclave,
+    oe_enclave_function_call_t* calls,
+    size_t num_calls)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_enclave_functions_args_t args;
+    oe_call_enclave_function_args_t* call_args = NULL;
+    size_t size;
+
+    /* Reject invalid parameters */
+    if (!enclave || !calls || num_calls == 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_safe_mul_sizet(num_calls, sizeof(*call_args), &size));
+
+    if (!(call_args = (oe_call_enclave_function_args_t*)malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    /* Initialize the call_enclave_args structure of each call */
+    for (size_t i = 0; i < num_calls; i++)
+    {
+        uint64_t function_id = OE_UINT64_MAX;
+
+        OE_CHECK(oe_get_ecall_ids(
+            enclave, calls[i].name, calls[i].global_id, &function_id));
+
+        call_args[i].function_id = function_id;
+        call_args[i].input_buffer = calls[i].input_buffer;
+        call_args[i].input_buffer_size = calls[i].input_buffer_size;
+        call_args[i].output_buffer = calls[i].output_buffer;
+        call_args[i].output_buffer_size = calls[i].output_buffer_size;
+        call_args[i].output_bytes_written = 0;
+        call_args[i].result = OE_UNEXPECTED;
+    }
+
+    args.calls = call_args;
+    args.num_calls = num_calls;
+
+    /* Perform the ECALL */
+    {
+        uint64_t arg_out = 0;
+
+        OE_CHECK(oe_ecall(
+            enclave,
+            OE_ECALL_CALL_ENCLAVE_FUNCTIONS,
+            (uint64_t)&args,
+            &arg_out));
+        OE_CHECK((oe_result_t)arg_out);
+    }
+
+    /* Return the result of each call */
+    for (size_t i = 0; i < num_calls; i++)
+    {
+        calls[i].result = call_args[i].result;
+        calls[i].output_bytes_written =
+            (call_args[i].result == OE_OK) ? call_args[i].output_bytes_written
+                                           : 0;
+    }
+
+    result = OE_OK;
+
+done:
+    free(call_args);
+    return result;
+}
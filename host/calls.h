@@ -17,4 +17,6 @@ typedef struct _ocall_table
 
 oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave);
 
+oe_result_t oe_handle_call_host_functions(uint64_t arg, oe_enclave_t* enclave);
+
 #endif /* OE_HOST_CALLS_H */
@@ -58,6 +58,22 @@ ssize_t oe_syscall_write_ocall(oe_host_fd_t fd, const void* buf, size_t count)
     return write((int)fd, buf, count);
 }
 
+ssize_t oe_syscall_read_switchless_ocall(
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count)
+{
+    return oe_syscall_read_ocall(fd, buf, count);
+}
+
+ssize_t oe_syscall_write_switchless_ocall(
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count)
+{
+    return oe_syscall_write_ocall(fd, buf, count);
+}
+
 static void _relocate_iov_bases(
     struct oe_iovec* iov,
     int iovcnt,
@@ -573,6 +589,15 @@ ssize_t oe_syscall_recv_ocall(
     return recv((int)sockfd, buf, len, flags);
 }
 
+ssize_t oe_syscall_recv_switchless_ocall(
+    oe_host_fd_t sockfd,
+    void* buf,
+    size_t len,
+    int flags)
+{
+    return oe_syscall_recv_ocall(sockfd, buf, len, flags);
+}
+
 ssize_t oe_syscall_recvfrom_ocall(
     oe_host_fd_t sockfd,
     void* buf,
@@ -609,6 +634,15 @@ ssize_t oe_syscall_send_ocall(
     return send((int)sockfd, buf, len, flags);
 }
 
+ssize_t oe_syscall_send_switchless_ocall(
+    oe_host_fd_t sockfd,
+    const void* buf,
+    size_t len,
+    int flags)
+{
+    return oe_syscall_send_ocall(sockfd, buf, len, flags);
+}
+
 ssize_t oe_syscall_sendto_ocall(
     oe_host_fd_t sockfd,
     const void* buf,
@@ -1164,6 +1198,15 @@ done:
     return ret;
 }
 
+int oe_syscall_epoll_wait_switchless_ocall(
+    int64_t epfd,
+    struct oe_epoll_event* events,
+    unsigned int maxevents,
+    int timeout)
+{
+    return oe_syscall_epoll_wait_ocall(epfd, events, maxevents, timeout);
+}
+
 int oe_syscall_epoll_wake_ocall(void)
 {
     int ret = -1;
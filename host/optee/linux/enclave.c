@@ -323,6 +323,33 @@ done:
     return result;
 }
 
+static oe_result_t _handle_call_enclave_function_inline(
+    oe_enclave_t* enclave,
+    oe_call_enclave_function_inline_args_t* inline_args)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_enclave_function_args_t args;
+    size_t output_offset =
+        OE_CALL_INLINE_OUTPUT_OFFSET(inline_args->input_buffer_size);
+
+    /* The buffers are shared with the TA anyway: pass the inline areas as
+     * regular input and output buffers */
+    args.function_id = inline_args->function_id;
+    args.input_buffer = inline_args->buffer;
+    args.input_buffer_size = inline_args->input_buffer_size;
+    args.output_buffer = inline_args->buffer + output_offset;
+    args.output_buffer_size = inline_args->output_buffer_size;
+    args.output_bytes_written = 0;
+    args.result = OE_UNEXPECTED;
+
+    result = _handle_call_enclave_function(enclave, &args);
+
+    inline_args->output_bytes_written = args.output_bytes_written;
+    inline_args->result = args.result;
+
+    return result;
+}
+
 static oe_result_t _uuid_from_string(const char* uuid_str, TEEC_UUID* uuid)
 {
     int i;
@@ -538,6 +565,11 @@ oe_result_t oe_ecall(
         result = _handle_call_enclave_function(
             enclave, (oe_call_enclave_function_args_t*)arg_in);
     }
+    else if (func == OE_ECALL_CALL_ENCLAVE_FUNCTION_INLINE)
+    {
+        result = _handle_call_enclave_function_inline(
+            enclave, (oe_call_enclave_function_inline_args_t*)arg_in);
+    }
     else
     {
         result = _handle_call_builtin_function(enclave, func, arg_in, arg_out);
@@ -582,3 +614,100 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
 done:
     return result;
 }
+
+oe_result_t oe_get_switchless_statistics(
+    oe_enclave_t* enclave,
+    oe_switchless_statistics_t* statistics)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(statistics);
+
+    /* Context-switchless calls are not supported on OP-TEE */
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_get_switchless_worker_statistics(
+    oe_enclave_t* enclave,
+    oe_switchless_worker_type_t type,
+    size_t index,
+    oe_switchless_worker_statistics_t* statistics)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(type);
+    OE_UNUSED(index);
+    OE_UNUSED(statistics);
+
+    /* Context-switchless calls are not supported on OP-TEE */
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_set_switchless_ecall_spin_budget(
+    oe_enclave_t* enclave,
+    uint64_t spin_budget_usec)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(spin_budget_usec);
+
+    /* Context-switchless calls are not supported on OP-TEE */
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_register_shared_memory(
+    oe_enclave_t* enclave,
+    void* address,
+    size_t size,
+    uint64_t* region_id)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(address);
+    OE_UNUSED(size);
+    OE_UNUSED(region_id);
+
+    /* Shared memory regions are not supported on OP-TEE */
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_unregister_shared_memory(
+    oe_enclave_t* enclave,
+    uint64_t region_id)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(region_id);
+
+    /* Shared memory regions are not supported on OP-TEE */
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_enable_call_latency_histograms(
+    oe_enclave_t* enclave,
+    bool enable)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(enable);
+
+    /* Call latency histograms are not supported on OP-TEE */
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_get_call_latency_histograms(
+    oe_enclave_t* enclave,
+    oe_call_direction_t direction,
+    oe_call_latency_histogram_t* histograms,
+    size_t* count)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(direction);
+    OE_UNUSED(histograms);
+    OE_UNUSED(count);
+
+    /* Call latency histograms are not supported on OP-TEE */
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_reset_call_latency_histograms(oe_enclave_t* enclave)
+{
+    OE_UNUSED(enclave);
+
+    /* Call latency histograms are not supported on OP-TEE */
+    return OE_UNSUPPORTED;
+}
@@ -0,0 +1,246 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/utils.h>
+#include <stdlib.h>
+#include <string.h>
+#include "enclave.h"
+
+/*
+**==============================================================================
+**
+** Call latency histograms
+**
+**     Each binding has one histogram per ECALL and per OCALL function of the
+**     enclave. Only the thread the binding is assigned to updates them, so
+**     measuring a call takes no lock. The histograms are allocated when they
+**     are first enabled and are only freed with the enclave, so a thread
+**     that sees call_histograms_enabled set also sees the histograms.
+**
+**     Resetting the histograms does not write to them: the current values
+**     are saved in call_histograms_reset and subtracted from the values
+**     returned by the later snapshots. Snapshots and resets are serialized
+**     by the enclave lock.
+**
+**==============================================================================
+*/
+
+static size_t _num_histograms(const oe_enclave_t* enclave)
+{
+    return enclave->num_ecalls + enclave->num_ocalls;
+}
+
+static oe_result_t _get_range(
+    const oe_enclave_t* enclave,
+    oe_call_direction_t direction,
+    size_t* first,
+    size_t* count)
+{
+    switch (direction)
+    {
+        case OE_CALL_DIRECTION_ECALL:
+            *first = 0;
+            *count = enclave->num_ecalls;
+            return OE_OK;
+        case OE_CALL_DIRECTION_OCALL:
+            *first = enclave->num_ecalls;
+            *count = enclave->num_ocalls;
+            return OE_OK;
+        default:
+            return OE_INVALID_PARAMETER;
+    }
+}
+
+void oe_record_call_latency(
+    oe_enclave_t* enclave,
+    oe_thread_binding_t* binding,
+    oe_call_direction_t direction,
+    uint64_t function_id,
+    uint64_t nsec)
+{
+    oe_call_latency_histogram_t* histogram = NULL;
+    size_t first = 0;
+    size_t count = 0;
+    size_t bucket = 0;
+
+    if (!binding->call_histograms ||
+        _get_range(enclave, direction, &first, &count) != OE_OK ||
+        function_id >= count)
+        return;
+
+    histogram = &binding->call_histograms[first + function_id];
+
+    while (bucket < OE_CALL_LATENCY_BUCKETS - 1 && (nsec >> (bucket + 1)))
+        bucket++;
+
+    histogram->count++;
+    histogram->total_nsec += nsec;
+    histogram->buckets[bucket]++;
+}
+
+oe_result_t oe_enable_call_latency_histograms(
+    oe_enclave_t* enclave,
+    bool enable)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t num_histograms = 0;
+    bool locked = false;
+
+    if (!enclave || enclave->magic != ENCLAVE_MAGIC)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (oe_mutex_lock(&enclave->lock) != 0)
+        OE_RAISE(OE_FAILURE);
+    locked = true;
+
+    num_histograms = _num_histograms(enclave);
+
+    if (enable && num_histograms)
+    {
+        for (size_t i = 0; i < enclave->num_bindings; i++)
+        {
+            oe_thread_binding_t* binding = &enclave->bindings[i];
+            oe_call_latency_histogram_t* histograms = NULL;
+            oe_call_latency_histogram_t* reset = NULL;
+
+            if (binding->call_histograms)
+                continue;
+
+            histograms = (oe_call_latency_histogram_t*)calloc(
+                num_histograms, sizeof(oe_call_latency_histogram_t));
+            reset = (oe_call_latency_histogram_t*)calloc(
+                num_histograms, sizeof(oe_call_latency_histogram_t));
+
+            if (!histograms || !reset)
+            {
+                free(histograms);
+                free(reset);
+                OE_RAISE(OE_OUT_OF_MEMORY);
+            }
+
+            binding->call_histograms_reset = reset;
+            binding->call_histograms = histograms;
+        }
+
+        /* Publish the histograms before enabling the measurements */
+        OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    }
+
+    enclave->call_histograms_enabled = enable;
+    result = OE_OK;
+
+done:
+    if (locked)
+        oe_mutex_unlock(&enclave->lock);
+
+    return result;
+}
+
+oe_result_t oe_get_call_latency_histograms(
+    oe_enclave_t* enclave,
+    oe_call_direction_t direction,
+    oe_call_latency_histogram_t* histograms,
+    size_t* count)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t first = 0;
+    size_t num_functions = 0;
+    bool locked = false;
+
+    if (!enclave || enclave->magic != ENCLAVE_MAGIC || !count)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!histograms && *count)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_get_range(enclave, direction, &first, &num_functions));
+
+    if (*count < num_functions)
+    {
+        *count = num_functions;
+        OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+    }
+
+    *count = num_functions;
+
+    if (oe_mutex_lock(&enclave->lock) != 0)
+        OE_RAISE(OE_FAILURE);
+    locked = true;
+
+    for (size_t f = 0; f < num_functions; f++)
+    {
+        oe_call_latency_histogram_t* histogram = &histograms[f];
+
+        memset(histogram, 0, sizeof(*histogram));
+        histogram->function_id = f;
+
+        for (size_t i = 0; i < enclave->num_bindings; i++)
+        {
+            const oe_thread_binding_t* binding = &enclave->bindings[i];
+            const volatile oe_call_latency_histogram_t* current;
+            const oe_call_latency_histogram_t* reset;
+
+            if (!binding->call_histograms)
+                continue;
+
+            current = &binding->call_histograms[first + f];
+            reset = &binding->call_histograms_reset[first + f];
+
+            histogram->count += current->count - reset->count;
+            histogram->total_nsec += current->total_nsec - reset->total_nsec;
+
+            for (size_t b = 0; b < OE_CALL_LATENCY_BUCKETS; b++)
+                histogram->buckets[b] +=
+                    current->buckets[b] - reset->buckets[b];
+        }
+    }
+
+    result = OE_OK;
+
+done:
+    if (locked)
+        oe_mutex_unlock(&enclave->lock);
+
+    return result;
+}
+
+oe_result_t oe_reset_call_latency_histograms(oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!enclave || enclave->magic != ENCLAVE_MAGIC)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (oe_mutex_lock(&enclave->lock) != 0)
+        OE_RAISE(OE_FAILURE);
+
+    for (size_t i = 0; i < enclave->num_bindings; i++)
+    {
+        oe_thread_binding_t* binding = &enclave->bindings[i];
+        const volatile oe_call_latency_histogram_t* current =
+            binding->call_histograms;
+
+        if (!current)
+            continue;
+
+        for (size_t f = 0; f < _num_histograms(enclave); f++)
+        {
+            oe_call_latency_histogram_t* reset =
+                &binding->call_histograms_reset[f];
+
+            reset->count = current[f].count;
+            reset->total_nsec = current[f].total_nsec;
+
+            for (size_t b = 0; b < OE_CALL_LATENCY_BUCKETS; b++)
+                reset->buckets[b] = current[f].buckets[b];
+        }
+    }
+
+    oe_mutex_unlock(&enclave->lock);
+    result = OE_OK;
+
+done:
+    return result;
+}
@@ -20,6 +20,7 @@
 
 #include <openenclave/bits/sgx/sgxtypes.h>
 #include <openenclave/host.h>
+#include <openenclave/internal/atomic.h>
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/debugrt/host.h>
 #include <openenclave/internal/raise.h>
@@ -50,9 +51,36 @@
 static oe_once_type _thread_binding_once;
 static oe_thread_key _thread_binding_key;
 
+/* The binding this thread released last. Kept across ECALLs so that a thread
+ * making repeated ECALLs reclaims the same (cache-warm) enclave thread context
+ * without scanning the bindings. It is only compared with the bindings of an
+ * enclave, never dereferenced, since its enclave may have been terminated. */
+static oe_thread_key _thread_binding_cache_key;
+
+/* Process-unique id of this thread, assigned on its first ECALL. The OS
+ * reuses the handles of exited threads, so they cannot tell a new thread from
+ * an old one. */
+static oe_thread_key _thread_id_key;
+static uint64_t _next_thread_id;
+
 static void _create_thread_binding_key(void)
 {
     oe_thread_key_create(&_thread_binding_key);
+    oe_thread_key_create(&_thread_binding_cache_key);
+    oe_thread_key_create(&_thread_id_key);
+}
+
+static uint64_t _get_thread_id(void)
+{
+    uint64_t id = (uint64_t)(uintptr_t)oe_thread_getspecific(_thread_id_key);
+
+    if (id == 0)
+    {
+        id = oe_atomic_increment(&_next_thread_id);
+        oe_thread_setspecific(_thread_id_key, (void*)(uintptr_t)id);
+    }
+
+    return id;
 }
 
 static void _set_thread_binding(oe_thread_binding_t* binding)
@@ -222,6 +250,8 @@ oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave)
     oe_ocall_func_t func = NULL;
     size_t buffer_size = 0;
     ocall_table_t ocall_table;
+    oe_thread_binding_t* binding = NULL;
+    uint64_t start = 0;
 
     args_ptr = (oe_call_host_function_args_t*)arg;
     if (args_ptr == NULL)
@@ -257,6 +287,11 @@ oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave)
     if ((args_ptr->output_buffer_size % OE_EDGER8R_BUFFER_ALIGNMENT) != 0)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    // Switchless OCALLs are handled by worker threads that have no binding.
+    if (enclave->call_histograms_enabled &&
+        (binding = oe_get_thread_binding()) && binding->enclave == enclave)
+        start = oe_switchless_get_time();
+
     // Call the function.
     func(
         args_ptr->input_buffer,
@@ -265,6 +300,14 @@ oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave)
         args_ptr->output_buffer_size,
         &args_ptr->output_bytes_written);
 
+    if (start)
+        oe_record_call_latency(
+            enclave,
+            binding,
+            OE_CALL_DIRECTION_OCALL,
+            args_ptr->function_id,
+            oe_switchless_get_time() - start);
+
     // The ocall succeeded.
     OE_ATOMIC_MEMORY_BARRIER_RELEASE();
     args_ptr->result = OE_OK;
@@ -274,6 +317,43 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** oe_handle_call_host_functions()
+**
+** Handle a batch of calls from the enclave. The calls are dispatched in order
+** and each one records its own status.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_handle_call_host_functions(uint64_t arg, oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_host_functions_args_t* args_ptr =
+        (oe_call_host_functions_args_t*)arg;
+
+    if (args_ptr == NULL || (args_ptr->calls == NULL && args_ptr->num_calls))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (size_t i = 0; i < args_ptr->num_calls; i++)
+    {
+        oe_call_host_function_args_t* call = &args_ptr->calls[i];
+        oe_result_t call_result =
+            oe_handle_call_host_function((uint64_t)call, enclave);
+
+        // oe_handle_call_host_function sets the result only on success.
+        if (call_result != OE_OK)
+            call->result = call_result;
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 static const char* oe_ocall_str(oe_func_t ocall)
 {
     // clang-format off
@@ -284,7 +364,8 @@ static const char* oe_ocall_str(oe_func_t ocall)
         "THREAD_WAIT",
         "MALLOC",
         "FREE",
-        "GET_TIME"
+        "GET_TIME",
+        "CALL_HOST_FUNCTIONS"
     };
     // clang-format on
 
@@ -304,7 +385,9 @@ static const char* oe_ecall_str(oe_func_t ecall)
         "DESTRUCTOR",
         "INIT_ENCLAVE",
         "CALL_ENCLAVE_FUNCTION",
-        "VIRTUAL_EXCEPTION_HANDLER"
+        "VIRTUAL_EXCEPTION_HANDLER",
+        "CALL_ENCLAVE_FUNCTIONS",
+        "CALL_ENCLAVE_FUNCTION_INLINE"
     };
     // clang-format on
 
@@ -346,7 +429,10 @@ static oe_result_t _handle_ocall(
         "%s 0x%x %s: %s\n",
         enclave->path,
         enclave->addr,
-        func == OE_OCALL_CALL_HOST_FUNCTION ? "EDL_OCALL" : "OE_OCALL",
+        (func == OE_OCALL_CALL_HOST_FUNCTION ||
+         func == OE_OCALL_CALL_HOST_FUNCTIONS)
+            ? "EDL_OCALL"
+            : "OE_OCALL",
         oe_ocall_str(func));
 
     switch ((oe_func_t)func)
@@ -375,6 +461,10 @@ static oe_result_t _handle_ocall(
             oe_handle_get_time(arg_in, arg_out);
             break;
 
+        case OE_OCALL_CALL_HOST_FUNCTIONS:
+            OE_CHECK(oe_handle_call_host_functions(arg_in, enclave));
+            break;
+
         default:
         {
             /* No function found with the number */
@@ -456,72 +546,105 @@ int __oe_dispatch_ocall(
 **         - an enclave thread context
 **
 **     If such a binding already exists, the binding's count in incremented.
-**     Else, the calling host thread is bound to the first available enclave
-**     thread context.
+**     Else, the calling host thread reclaims the binding it released last,
+**     which stays cached in TSD, if that binding is still free. Failing that,
+**     it is bound to the first available enclave thread context.
 **
-**     Returns the address of the thread control structure (TCS) corresponding
-**     to the enclave thread context.
+**     Bindings are claimed through the enclave's busy bitmap without taking
+**     the enclave lock. Returns NULL if all enclave thread contexts are busy.
 **
 **==============================================================================
 */
 
-static void* _assign_tcs(oe_enclave_t* enclave)
+static oe_thread_binding_t* _assign_tcs(oe_enclave_t* enclave)
 {
-    void* tcs = NULL;
-    size_t i;
+    oe_thread_binding_t* binding = oe_get_thread_binding();
     oe_thread_t thread = oe_thread_self();
+    size_t num_bindings = enclave->num_bindings;
+    uintptr_t cached;
+    size_t index;
+    size_t i;
 
-    oe_mutex_lock(&enclave->lock);
+    OE_STATIC_ASSERT(OE_SGX_MAX_TCS <= 64);
+
+    /* Nested ECALL: the binding cached in TSD is owned by this thread */
+    if (binding && binding->enclave == enclave &&
+        (binding->flags & _OE_THREAD_BUSY) && binding->thread == thread)
+        goto found;
+
+    /* The TSD binding may belong to another enclave if this thread entered
+     * this enclave, made an OCALL and then called into a different enclave
+     * that made an OCALL. Look for a busy binding owned by this thread. A
+     * binding owned by this thread cannot change underneath us, and a
+     * binding owned by another thread never matches this thread. */
+    for (i = 0; i < num_bindings; i++)
     {
-        /* First attempt to find a busy oe_sgx_td_t owned by this thread */
-        for (i = 0; i < enclave->num_bindings; i++)
-        {
-            oe_thread_binding_t* binding = &enclave->bindings[i];
+        binding = &enclave->bindings[i];
 
-            if ((binding->flags & _OE_THREAD_BUSY) && binding->thread == thread)
-            {
-                binding->count++;
-                tcs = (void*)binding->tcs;
+        if ((oe_atomic_load(&enclave->busy_bindings) & (1ULL << i)) &&
+            (binding->flags & _OE_THREAD_BUSY) && binding->thread == thread)
+            goto found;
+    }
 
-                /* Notify the debugger runtime */
-                if (enclave->debug && enclave->debug_enclave != NULL)
-                    oe_debug_push_thread_binding(
-                        enclave->debug_enclave, (sgx_tcs_t*)tcs);
-                break;
-            }
-        }
+    /* Reclaim the binding this thread released last if it is still free */
+    cached = (uintptr_t)oe_thread_getspecific(_thread_binding_cache_key);
+
+    if (cached >= (uintptr_t)enclave->bindings &&
+        cached < (uintptr_t)(enclave->bindings + num_bindings))
+    {
+        uint64_t busy = oe_atomic_load(&enclave->busy_bindings);
+        index = (size_t)((oe_thread_binding_t*)cached - enclave->bindings);
+
+        if (!(busy & (1ULL << index)) &&
+            oe_atomic_compare_and_swap(
+                (int64_t volatile*)&enclave->busy_bindings,
+                (int64_t)busy,
+                (int64_t)(busy | (1ULL << index))))
+            goto claimed;
+    }
+
+    /* Otherwise claim the first free binding */
+    for (;;)
+    {
+        uint64_t busy = oe_atomic_load(&enclave->busy_bindings);
 
-        /* If binding not found above, look for an available ThreadBinding */
-        if (!tcs)
+        for (index = 0; index < num_bindings; index++)
         {
-            for (i = 0; i < enclave->num_bindings; i++)
-            {
-                oe_thread_binding_t* binding = &enclave->bindings[i];
-
-                if (!(binding->flags & _OE_THREAD_BUSY))
-                {
-                    binding->flags |= _OE_THREAD_BUSY;
-                    binding->thread = thread;
-                    binding->count = 1;
-
-                    tcs = (void*)binding->tcs;
-
-                    /* Set into TSD so asynchronous exceptions can get it */
-                    _set_thread_binding(binding);
-                    assert(oe_get_thread_binding() == binding);
-
-                    /* Notify the debugger runtime */
-                    if (enclave->debug && enclave->debug_enclave != NULL)
-                        oe_debug_push_thread_binding(
-                            enclave->debug_enclave, (sgx_tcs_t*)tcs);
-                    break;
-                }
-            }
+            if (!(busy & (1ULL << index)))
+                break;
         }
+
+        /* All enclave thread contexts are in use */
+        if (index == num_bindings)
+            return NULL;
+
+        if (oe_atomic_compare_and_swap(
+                (int64_t volatile*)&enclave->busy_bindings,
+                (int64_t)busy,
+                (int64_t)(busy | (1ULL << index))))
+            goto claimed;
     }
-    oe_mutex_unlock(&enclave->lock);
 
-    return tcs;
+claimed:
+    binding = &enclave->bindings[index];
+    binding->flags |= _OE_THREAD_BUSY;
+    binding->thread = thread;
+    binding->thread_id = _get_thread_id();
+    binding->count = 0;
+
+    /* Set into TSD so asynchronous exceptions can get it */
+    _set_thread_binding(binding);
+    assert(oe_get_thread_binding() == binding);
+
+found:
+    binding->count++;
+
+    /* Notify the debugger runtime */
+    if (enclave->debug && enclave->debug_enclave != NULL)
+        oe_debug_push_thread_binding(
+            enclave->debug_enclave, (sgx_tcs_t*)binding->tcs);
+
+    return binding;
 }
 
 /*
@@ -529,44 +652,44 @@ static void* _assign_tcs(oe_enclave_t* enclave)
 **
 ** _release_tcs()
 **
-**     Decrement the ThreadBinding.count field of the binding associated with
-**     the given TCS. If the field becomes zero, the binding is dissolved.
+**     Decrement the ThreadBinding.count field of the given binding. If the
+**     field becomes zero, the binding is dissolved and its bit in the
+**     enclave's busy bitmap is cleared.
 **
 **==============================================================================
 */
 
-static void _release_tcs(oe_enclave_t* enclave, void* tcs)
+static void _release_tcs(oe_enclave_t* enclave, oe_thread_binding_t* binding)
 {
-    size_t i;
+    size_t index = (size_t)(binding - enclave->bindings);
+    uint64_t busy;
+
+    binding->count--;
 
-    oe_mutex_lock(&enclave->lock);
+    /* Notify the debugger runtime */
+    if (enclave->debug && enclave->debug_enclave != NULL)
+        oe_debug_pop_thread_binding();
+
+    if (binding->count == 0)
     {
-        for (i = 0; i < enclave->num_bindings; i++)
+        binding->flags &= (~_OE_THREAD_BUSY);
+        binding->thread = 0;
+        memset(&binding->event, 0, sizeof(binding->event));
+        _set_thread_binding(NULL);
+        assert(oe_get_thread_binding() == NULL);
+
+        /* Keep it cached so that the next ECALL of this thread reclaims it */
+        oe_thread_setspecific(_thread_binding_cache_key, binding);
+
+        /* Publish the binding as free only after it has been reset */
+        do
         {
-            oe_thread_binding_t* binding = &enclave->bindings[i];
-
-            if ((binding->flags & _OE_THREAD_BUSY) &&
-                (void*)binding->tcs == tcs)
-            {
-                binding->count--;
-
-                /* Notify the debugger runtime */
-                if (enclave->debug && enclave->debug_enclave != NULL)
-                    oe_debug_pop_thread_binding();
-
-                if (binding->count == 0)
-                {
-                    binding->flags &= (~_OE_THREAD_BUSY);
-                    binding->thread = 0;
-                    memset(&binding->event, 0, sizeof(binding->event));
-                    _set_thread_binding(NULL);
-                    assert(oe_get_thread_binding() == NULL);
-                }
-                break;
-            }
-        }
+            busy = oe_atomic_load(&enclave->busy_bindings);
+        } while (!oe_atomic_compare_and_swap(
+            (int64_t volatile*)&enclave->busy_bindings,
+            (int64_t)busy,
+            (int64_t)(busy & ~(1ULL << index))));
     }
-    oe_mutex_unlock(&enclave->lock);
 }
 
 /*
@@ -586,18 +709,19 @@ oe_result_t oe_ecall(
     uint64_t* arg_out_ptr)
 {
     oe_result_t result = OE_UNEXPECTED;
-    void* tcs = NULL;
+    oe_thread_binding_t* binding = NULL;
     oe_code_t code = OE_CODE_ECALL;
     oe_code_t code_out = 0;
     uint16_t func_out = 0;
     uint16_t result_out = 0;
     uint64_t arg_out = 0;
+    uint64_t start = 0;
 
     if (!enclave)
         OE_RAISE(OE_INVALID_PARAMETER);
 
     /* Assign a oe_sgx_td_t for this operation */
-    if (!(tcs = _assign_tcs(enclave)))
+    if (!(binding = _assign_tcs(enclave)))
         OE_RAISE(OE_OUT_OF_THREADS);
 
     oe_log(
@@ -605,13 +729,22 @@ oe_result_t oe_ecall(
         "%s 0x%x %s: %s\n",
         enclave->path,
         enclave->addr,
-        func == OE_ECALL_CALL_ENCLAVE_FUNCTION ? "EDL_ECALL" : "OE_ECALL",
+        (func == OE_ECALL_CALL_ENCLAVE_FUNCTION ||
+         func == OE_ECALL_CALL_ENCLAVE_FUNCTIONS ||
+         func == OE_ECALL_CALL_ENCLAVE_FUNCTION_INLINE)
+            ? "EDL_ECALL"
+            : "OE_ECALL",
         oe_ecall_str(func));
 
+    if ((func == OE_ECALL_CALL_ENCLAVE_FUNCTION ||
+         func == OE_ECALL_CALL_ENCLAVE_FUNCTION_INLINE) &&
+        enclave->call_histograms_enabled)
+        start = oe_switchless_get_time();
+
     /* Perform ECALL or ORET */
     OE_CHECK(_do_eenter(
         enclave,
-        tcs,
+        (void*)binding->tcs,
         OE_AEP_ADDRESS,
         code,
         func,
@@ -625,6 +758,16 @@ oe_result_t oe_ecall(
     if (code_out != OE_CODE_ERET)
         OE_RAISE(OE_UNEXPECTED);
 
+    if (start)
+        oe_record_call_latency(
+            enclave,
+            binding,
+            OE_CALL_DIRECTION_ECALL,
+            func == OE_ECALL_CALL_ENCLAVE_FUNCTION
+                ? ((oe_call_enclave_function_args_t*)arg)->function_id
+                : ((oe_call_enclave_function_inline_args_t*)arg)->function_id,
+            oe_switchless_get_time() - start);
+
     if (arg_out_ptr)
         *arg_out_ptr = arg_out;
 
@@ -632,8 +775,8 @@ oe_result_t oe_ecall(
 
 done:
 
-    if (enclave && tcs)
-        _release_tcs(enclave, tcs);
+    if (enclave && binding)
+        _release_tcs(enclave, binding);
 
     /* ATTN: this causes an assertion with call nesting. */
     /* ATTN: make enclave argument a cookie. */
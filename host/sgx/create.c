@@ -59,6 +59,7 @@ static char* get_fullpath(const char* path)
 #include "cpuid.h"
 #include "enclave.h"
 #include "exception.h"
+#include "measurecache.h"
 #include "platform_u.h"
 #include "sgxload.h"
 
@@ -109,7 +110,6 @@ static oe_result_t _add_filled_pages(
 {
     oe_result_t result = OE_UNEXPECTED;
     oe_page_t* page = NULL;
-    size_t i;
 
     page = oe_memalign(OE_PAGE_SIZE, sizeof(oe_page_t));
     if (!page)
@@ -131,17 +131,17 @@ static oe_result_t _add_filled_pages(
     else
         memset(page, 0, sizeof(*page));
 
-    /* Add the pages */
-    for (i = 0; i < npages; i++)
-    {
-        uint64_t addr = enclave_addr + *vaddr;
-        uint64_t src = (uint64_t)page;
-        uint64_t flags = SGX_SECINFO_REG | SGX_SECINFO_R | SGX_SECINFO_W;
-
-        OE_CHECK(oe_sgx_load_enclave_data(
-            context, enclave_addr, addr, src, flags, extend));
-        (*vaddr) += OE_PAGE_SIZE;
-    }
+    /* Add the pages, loading the same filled page into each of them */
+    OE_CHECK(oe_sgx_load_enclave_pages(
+        context,
+        enclave_addr,
+        enclave_addr + *vaddr,
+        (uint64_t)page,
+        npages,
+        SGX_SECINFO_REG | SGX_SECINFO_R | SGX_SECINFO_W,
+        extend,
+        0));
+    (*vaddr) += npages * OE_PAGE_SIZE;
 
     result = OE_OK;
 
@@ -483,7 +483,12 @@ static oe_result_t _configure_enclave(
     uint32_t setting_count)
 {
     oe_result_t result = OE_UNEXPECTED;
+    oe_enclave_setting_context_switchless_elastic_t switchless_setting = {0};
+    bool has_switchless_setting = false;
+    const oe_enclave_setting_context_switchless_placement_t* placement = NULL;
 
+    // Collect the switchless settings first: the placement applies to the
+    // workers whichever setting creates them.
     for (uint32_t i = 0; i < setting_count; i++)
     {
         switch (settings[i].setting_type)
@@ -491,14 +496,65 @@ static oe_result_t _configure_enclave(
             // Configure the switchless ocalls, such as the number of workers.
             case OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS:
             {
-                size_t max_host_workers =
-                    settings[i].u.context_switchless_setting->max_host_workers;
-                size_t max_enclave_workers =
-                    settings[i]
-                        .u.context_switchless_setting->max_enclave_workers;
-
-                OE_CHECK(oe_start_switchless_manager(
-                    enclave, max_host_workers, max_enclave_workers));
+                const oe_enclave_setting_context_switchless_t* setting =
+                    settings[i].u.context_switchless_setting;
+
+                if (setting == NULL)
+                    OE_RAISE(OE_INVALID_PARAMETER);
+
+                // Each enclave has at most one switchless manager.
+                if (has_switchless_setting)
+                    OE_RAISE(OE_UNEXPECTED);
+
+                // A fixed-size pool is an elastic pool whose min and max are
+                // equal.
+                switchless_setting.min_host_workers = setting->max_host_workers;
+                switchless_setting.max_host_workers = setting->max_host_workers;
+                switchless_setting.min_enclave_workers =
+                    setting->max_enclave_workers;
+                switchless_setting.max_enclave_workers =
+                    setting->max_enclave_workers;
+                switchless_setting.target_utilization = 100;
+                has_switchless_setting = true;
+                break;
+            }
+            // Configure switchless calls served by elastic worker pools.
+            case OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS_ELASTIC:
+            {
+                if (settings[i].u.context_switchless_elastic_setting == NULL)
+                    OE_RAISE(OE_INVALID_PARAMETER);
+
+                if (has_switchless_setting)
+                    OE_RAISE(OE_UNEXPECTED);
+
+                switchless_setting =
+                    *settings[i].u.context_switchless_elastic_setting;
+                has_switchless_setting = true;
+                break;
+            }
+            // Configure where the switchless workers and contexts are placed.
+            case OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS_PLACEMENT:
+            {
+                if (placement != NULL ||
+                    settings[i].u.context_switchless_placement_setting == NULL)
+                    OE_RAISE(OE_INVALID_PARAMETER);
+
+                placement = settings[i].u.context_switchless_placement_setting;
+                break;
+            }
+            // Configure the size of the per-thread ocall buffers.
+            case OE_ENCLAVE_SETTING_OCALL_BUFFER:
+            {
+                const oe_enclave_setting_ocall_buffer_t* setting =
+                    settings[i].u.ocall_buffer_setting;
+
+                if (setting == NULL)
+                    OE_RAISE(OE_INVALID_PARAMETER);
+
+                if (setting->initial_size)
+                    enclave->ocall_buffer_initial_size = setting->initial_size;
+                if (setting->max_size)
+                    enclave->ocall_buffer_max_size = setting->max_size;
                 break;
             }
 #ifdef OE_WITH_EXPERIMENTAL_EEID
@@ -512,6 +568,11 @@ static oe_result_t _configure_enclave(
                 OE_RAISE(OE_INVALID_PARAMETER);
         }
     }
+
+    if (has_switchless_setting)
+        OE_CHECK(oe_start_elastic_switchless_manager(
+            enclave, &switchless_setting, placement));
+
     result = OE_OK;
 
 done:
@@ -777,6 +838,8 @@ oe_result_t oe_sgx_build_enclave(
     size_t tls_page_count;
     uint64_t vaddr = 0;
     oe_sgx_enclave_properties_t props;
+    bool use_measurement_cache = false;
+    OE_SHA256 measurement_cache_key;
 
     if (!enclave)
         OE_RAISE(OE_INVALID_PARAMETER);
@@ -893,6 +956,27 @@ oe_result_t oe_sgx_build_enclave(
     /* Patch image */
     OE_CHECK(oeimage.sgx_patch(&oeimage, context, enclave_size));
 
+    /* Skip measuring the pages if this enclave was already built before */
+    use_measurement_cache = oe_sgx_is_measurement_cache_enabled();
+#ifdef OE_WITH_EXPERIMENTAL_EEID
+    /* EEID pages extend the hash outside of oe_sgx_load_enclave_data() */
+    if (context->eeid)
+        use_measurement_cache = false;
+#endif
+
+    if (use_measurement_cache)
+    {
+        OE_CHECK(oe_sgx_get_measurement_cache_key(
+            &oeimage,
+            &props,
+            context->attributes.flags,
+            enclave_size,
+            tls_page_count,
+            &measurement_cache_key));
+        context->use_cached_mrenclave = oe_sgx_find_cached_measurement(
+            &measurement_cache_key, &context->cached_mrenclave);
+    }
+
     /* Add image to enclave */
     OE_CHECK(oeimage.add_pages(&oeimage, context, enclave, &vaddr));
 
@@ -928,6 +1012,9 @@ oe_result_t oe_sgx_build_enclave(
     OE_CHECK(oe_sgx_initialize_enclave(
         context, enclave_addr, &props, &enclave->hash));
 
+    if (use_measurement_cache && !context->use_cached_mrenclave)
+        oe_sgx_add_cached_measurement(&measurement_cache_key, &enclave->hash);
+
     /* Save full path of this enclave. When a debugger attaches to the host
      * process, it needs the fullpath so that it can load the image binary and
      * extract the debugging symbols. */
@@ -1041,6 +1128,9 @@ oe_result_t oe_create_enclave(
     if (!(enclave = (oe_enclave_t*)calloc(1, sizeof(oe_enclave_t))))
         OE_RAISE(OE_OUT_OF_MEMORY);
 
+    enclave->ocall_buffer_initial_size = OE_DEFAULT_OCALL_BUFFER_SIZE;
+    enclave->ocall_buffer_max_size = OE_DEFAULT_MAX_OCALL_BUFFER_SIZE;
+
 #if defined(_WIN32)
     /* Create Windows events for each TCS binding. Enclaves use
      * this event when calling into the host to handle waits/wakes
@@ -1214,11 +1304,19 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
         {
             oe_thread_binding_t* binding = &enclave->bindings[i];
             CloseHandle(binding->event.handle);
-            free(binding->ocall_buffer);
         }
 
 #endif
 
+        /* Release the ocall buffers and the call latency histograms
+         * allocated by the bindings */
+        for (size_t i = 0; i < enclave->num_bindings; i++)
+        {
+            free(enclave->bindings[i].ocall_buffer);
+            free(enclave->bindings[i].call_histograms);
+            free(enclave->bindings[i].call_histograms_reset);
+        }
+
         /* Free the path name of the enclave image file */
         free(enclave->path);
     }
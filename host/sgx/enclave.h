@@ -45,6 +45,10 @@ typedef struct _enclave_event
 **
 **         ThreadBinding.busy == true
 **
+**     The bit with the same index in oe_enclave_t.busy_bindings is set while
+**     the binding is active. A thread claims a binding by atomically setting
+**     that bit and only the owning thread modifies the binding afterwards.
+**
 **     Due to nesting, the same thread may bind to the same enclave thread
 **     context more than once. The ThreadBinding.count field indicates how
 **     many bindings are in effect.
@@ -60,6 +64,9 @@ typedef struct _thread_binding
     /* The thread this slot is assigned to */
     oe_thread_t thread;
 
+    /* Process-unique id of that thread, never reused by another thread */
+    uint64_t thread_id;
+
     /* Flags */
     uint64_t flags;
 
@@ -76,8 +83,34 @@ typedef struct _thread_binding
     /* Buffer used for ocall parameters */
     void* ocall_buffer;
     uint64_t ocall_buffer_size;
+
+    /* OCALLs that did not fit in ocall_buffer since it was last resized, and
+     * the size of the largest of them */
+    uint64_t ocall_buffer_misses;
+    uint64_t ocall_buffer_miss_size;
+
+    /* Latency histograms of the ECALLs then of the OCALLs made through this
+     * binding, indexed by function id, and the values they had when they
+     * were last reset. Only the thread the binding is assigned to updates
+     * the histograms. */
+    oe_call_latency_histogram_t* call_histograms;
+    oe_call_latency_histogram_t* call_histograms_reset;
 } oe_thread_binding_t;
 
+/**
+ * Default initial size of the ocall buffers of the bindings. Large enough for
+ * most ocalls. If an ocall requires more than this size, then the enclave will
+ * make an ocall to allocate the buffer instead of using the binding's buffer.
+ * Note: Currently, quotes are about 10KB.
+ */
+#define OE_DEFAULT_OCALL_BUFFER_SIZE (16 * 1024)
+
+/* Default size the ocall buffers of the bindings may grow to */
+#define OE_DEFAULT_MAX_OCALL_BUFFER_SIZE (1024 * 1024)
+
+/* Number of ocalls that must miss the ocall buffer before it is grown */
+#define OE_OCALL_BUFFER_GROW_THRESHOLD 4
+
 /* Whether this binding is busy */
 #define _OE_THREAD_BUSY 0X1UL
 
@@ -110,6 +143,11 @@ typedef struct _oe_enclave
     size_t num_bindings;
     oe_mutex lock;
 
+    /* Bitmap of busy bindings (bit i set if bindings[i] is busy). Bits are
+     * claimed and released with compare-and-swap so that ECALLs never take
+     * the enclave lock. */
+    volatile uint64_t busy_bindings;
+
     /* Hash of enclave (MRENCLAVE) */
     OE_SHA256 hash;
 
@@ -126,6 +164,13 @@ typedef struct _oe_enclave
     /* Meta-data needed by debugrt  */
     oe_debug_enclave_t* debug_enclave;
 
+    /* Initial and maximum sizes of the per-binding ocall buffers */
+    uint64_t ocall_buffer_initial_size;
+    uint64_t ocall_buffer_max_size;
+
+    /* Whether the latency of the calls is measured */
+    volatile bool call_histograms_enabled;
+
     /* Manager for switchless calls */
     oe_switchless_call_manager_t* switchless_manager;
 
@@ -135,6 +180,14 @@ typedef struct _oe_enclave
     size_t num_ecalls;
 } oe_enclave_t;
 
+/* Add a call that took nsec nanoseconds to the histograms of the binding */
+void oe_record_call_latency(
+    oe_enclave_t* enclave,
+    oe_thread_binding_t* binding,
+    oe_call_direction_t direction,
+    uint64_t function_id,
+    uint64_t nsec);
+
 /* Get the event for the given TCS */
 EnclaveEvent* GetEnclaveEvent(oe_enclave_t* enclave, uint64_t tcs);
 
@@ -97,28 +97,84 @@ int __oe_host_stack_bridge(
 }
 
 /**
- * Size of ocall buffers passed in ecall_contexts. Large enough for most ocalls.
- * If an ocall requires more than this size, then the enclave will make an
- * ocall to allocate the buffer instead of using the ecall_context's buffer.
- * Note: Currently, quotes are about 10KB.
+ * Resize the ocall buffer of the binding if needed.
+ *
+ * The buffer is brought up to the enclave's initial size, and is doubled
+ * until it fits the largest OCALL that missed it once the enclave has
+ * reported OE_OCALL_BUFFER_GROW_THRESHOLD misses. If the allocation fails,
+ * the current buffer is kept and large OCALLs keep falling back to
+ * host-allocated buffers.
  */
-#define OE_DEFAULT_OCALL_BUFFER_SIZE (16 * 1024)
+static void _resize_ocall_buffer(
+    oe_enclave_t* enclave,
+    oe_thread_binding_t* binding)
+{
+    uint64_t size = binding->ocall_buffer_size;
+    void* buffer = NULL;
+
+    if (size < enclave->ocall_buffer_initial_size)
+        size = enclave->ocall_buffer_initial_size;
+
+    if (binding->ocall_buffer_misses >= OE_OCALL_BUFFER_GROW_THRESHOLD)
+    {
+        while (size < binding->ocall_buffer_miss_size &&
+               size < enclave->ocall_buffer_max_size)
+            size *= 2;
+
+        // Never grow past the max, nor shrink a buffer already beyond it.
+        if (size > enclave->ocall_buffer_max_size &&
+            size > binding->ocall_buffer_size)
+            size = enclave->ocall_buffer_max_size > binding->ocall_buffer_size
+                       ? enclave->ocall_buffer_max_size
+                       : binding->ocall_buffer_size;
+
+        binding->ocall_buffer_misses = 0;
+        binding->ocall_buffer_miss_size = 0;
+    }
+
+    if (binding->ocall_buffer && size == binding->ocall_buffer_size)
+        return;
+
+    if ((buffer = malloc(size)))
+    {
+        free(binding->ocall_buffer);
+        binding->ocall_buffer = buffer;
+        binding->ocall_buffer_size = size;
+    }
+}
 
 /**
  * Setup the ecall_context.
  */
-OE_INLINE void _setup_ecall_context(oe_ecall_context_t* ecall_context)
+OE_INLINE oe_thread_binding_t* _setup_ecall_context(
+    oe_enclave_t* enclave,
+    oe_ecall_context_t* ecall_context)
 {
     oe_thread_binding_t* binding = oe_get_thread_binding();
-    if (binding->ocall_buffer == NULL)
-    {
-        // Lazily allocate buffer for making ocalls. Bound to the tcs.
-        // Will be cleaned up by enclave during termination.
-        binding->ocall_buffer = malloc(OE_DEFAULT_OCALL_BUFFER_SIZE);
-        binding->ocall_buffer_size = OE_DEFAULT_OCALL_BUFFER_SIZE;
-    }
+
+    // Lazily allocate buffer for making ocalls. Bound to the tcs.
+    // Will be cleaned up by enclave during termination.
+    // Nested ECALLs share the buffer with the OCALLs in progress on the
+    // binding, so only the outermost ECALL may replace it.
+    if (binding->count == 1)
+        _resize_ocall_buffer(enclave, binding);
+
     ecall_context->ocall_buffer = binding->ocall_buffer;
     ecall_context->ocall_buffer_size = binding->ocall_buffer_size;
+    ecall_context->host_thread = binding->thread_id;
+    return binding;
+}
+
+/**
+ * Collect the OCALL buffer misses the enclave reported in the ecall_context.
+ */
+OE_INLINE void _teardown_ecall_context(
+    oe_thread_binding_t* binding,
+    oe_ecall_context_t* ecall_context)
+{
+    binding->ocall_buffer_misses += ecall_context->ocall_buffer_misses;
+    if (ecall_context->ocall_buffer_miss_size > binding->ocall_buffer_miss_size)
+        binding->ocall_buffer_miss_size = ecall_context->ocall_buffer_miss_size;
 }
 
 /**
@@ -162,7 +218,8 @@ void oe_enter(
     OE_ALIGNED(16)
     uint64_t fx_state[64];
     oe_ecall_context_t ecall_context = {{0}};
-    _setup_ecall_context(&ecall_context);
+    oe_thread_binding_t* binding =
+        _setup_ecall_context(enclave, &ecall_context);
 
     while (1)
     {
@@ -202,6 +259,8 @@ void oe_enter(
             break;
     }
 
+    _teardown_ecall_context(binding, &ecall_context);
+
     *arg3 = arg1;
     *arg4 = arg2;
 }
@@ -235,7 +294,8 @@ void oe_enter_sim(
     void* host_gs = oe_get_gs_register_base();
     sgx_tcs_t* sgx_tcs = (sgx_tcs_t*)tcs;
     oe_ecall_context_t ecall_context = {{0}};
-    _setup_ecall_context(&ecall_context);
+    oe_thread_binding_t* binding =
+        _setup_ecall_context(enclave, &ecall_context);
 
     while (1)
     {
@@ -293,6 +353,8 @@ void oe_enter_sim(
             break;
     }
 
+    _teardown_ecall_context(binding, &ecall_context);
+
     *arg3 = arg1;
     *arg4 = arg2;
 }
@@ -1,10 +1,16 @@
 // Copyright (c) Open Enclave SDK contributors.
 // Licensed under the MIT License.
 
+#include <openenclave/internal/raise.h>
 #include <openenclave/internal/switchless.h>
+#include <openenclave/internal/trace.h>
 
 #include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
 #include <sys/syscall.h>
+#include <time.h>
 #include <unistd.h>
 
 static void _worker_wait(volatile int* event)
@@ -69,3 +75,128 @@ void oe_enclave_worker_wake(oe_enclave_worker_context_t* context)
 {
     _worker_wake(&context->event);
 }
+
+void oe_switchless_caller_wait(oe_enclave_worker_context_t* context)
+{
+    // Error codes and spurious wakes are handled by the caller checking the
+    // call again.
+    syscall(
+        __NR_futex,
+        &context->caller_event,
+        FUTEX_WAIT_PRIVATE,
+        0,
+        NULL,
+        NULL,
+        0);
+}
+
+void oe_switchless_caller_wake(oe_enclave_worker_context_t* context)
+{
+    _worker_wake(&context->caller_event);
+}
+
+void oe_switchless_monitor_wait(
+    oe_switchless_call_manager_t* manager,
+    uint32_t timeout_msec)
+{
+    struct timespec timeout = {.tv_sec = timeout_msec / 1000,
+                               .tv_nsec = (timeout_msec % 1000) * 1000000};
+
+    // The event is set only when the monitor is stopping. Error codes,
+    // timeouts and spurious wakes are all handled by the caller checking
+    // is_monitor_stopping.
+    syscall(
+        __NR_futex,
+        &manager->monitor_event,
+        FUTEX_WAIT_PRIVATE,
+        0,
+        &timeout,
+        NULL,
+        0);
+}
+
+void oe_switchless_monitor_wake(oe_switchless_call_manager_t* manager)
+{
+    _worker_wake(&manager->monitor_event);
+}
+
+uint64_t oe_switchless_get_time(void)
+{
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+
+    return (uint64_t)ts.tv_sec * 1000000000UL + (uint64_t)ts.tv_nsec;
+}
+
+oe_result_t oe_switchless_set_thread_affinity(oe_thread_t thread, uint32_t cpu)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    cpu_set_t cpus;
+
+    if (cpu >= CPU_SETSIZE)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+
+    if (pthread_setaffinity_np((pthread_t)thread, sizeof(cpus), &cpus) != 0)
+        OE_RAISE_MSG(OE_FAILURE, "cannot pin worker to CPU %u", cpu);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* From <numaif.h>, which comes with libnuma. */
+#define OE_MPOL_PREFERRED 1
+#define OE_NUMA_MAX_NODES 1024
+
+void* oe_switchless_allocate_contexts(size_t size, int32_t numa_node)
+{
+    void* contexts = mmap(
+        NULL,
+        size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0);
+
+    if (contexts == MAP_FAILED)
+        return NULL;
+
+    // The pages are not backed until first touched, so setting the policy
+    // now places all of them on the node. The policy is only a preference:
+    // if the node is full or does not exist, the contexts are still usable.
+    if (numa_node >= 0 && numa_node < OE_NUMA_MAX_NODES)
+    {
+        unsigned long nodes[OE_NUMA_MAX_NODES / (8 * sizeof(unsigned long))] =
+            {0};
+        const size_t bits = 8 * sizeof(unsigned long);
+
+        nodes[(size_t)numa_node / bits] |= 1UL << ((size_t)numa_node % bits);
+
+        if (syscall(
+                __NR_mbind,
+                contexts,
+                size,
+                OE_MPOL_PREFERRED,
+                nodes,
+                OE_NUMA_MAX_NODES + 1,
+                0) != 0)
+        {
+            OE_TRACE_WARNING(
+                "cannot allocate switchless contexts on NUMA node %d\n",
+                numa_node);
+        }
+    }
+
+    return contexts;
+}
+
+void oe_switchless_free_contexts(void* contexts, size_t size)
+{
+    munmap(contexts, size);
+}
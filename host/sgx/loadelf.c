@@ -550,17 +550,16 @@ static oe_result_t _add_relocation_pages(
         const oe_page_t* pages = (const oe_page_t*)reloc_data;
         size_t npages = reloc_size / sizeof(oe_page_t);
 
-        for (size_t i = 0; i < npages; i++)
-        {
-            uint64_t addr = enclave_addr + *vaddr;
-            uint64_t src = (uint64_t)&pages[i];
-            uint64_t flags = SGX_SECINFO_REG | SGX_SECINFO_R;
-            bool extend = true;
-
-            OE_CHECK(oe_sgx_load_enclave_data(
-                context, enclave_addr, addr, src, flags, extend));
-            (*vaddr) += sizeof(oe_page_t);
-        }
+        OE_CHECK(oe_sgx_load_enclave_pages(
+            context,
+            enclave_addr,
+            enclave_addr + *vaddr,
+            (uint64_t)pages,
+            npages,
+            SGX_SECINFO_REG | SGX_SECINFO_R,
+            true,
+            sizeof(oe_page_t)));
+        (*vaddr) += npages * sizeof(oe_page_t);
     }
 
     result = OE_OK;
@@ -597,16 +596,15 @@ static oe_result_t _add_segment_pages(
 
     flags |= SGX_SECINFO_REG;
 
-    for (; page_rva < segment_end; page_rva += OE_PAGE_SIZE)
-    {
-        OE_CHECK(oe_sgx_load_enclave_data(
-            context,
-            enclave_addr,
-            enclave_addr + page_rva,
-            (uint64_t)image + page_rva,
-            flags,
-            true));
-    }
+    OE_CHECK(oe_sgx_load_enclave_pages(
+        context,
+        enclave_addr,
+        enclave_addr + page_rva,
+        (uint64_t)image + page_rva,
+        oe_round_up_to_page_size(segment_end - page_rva) / OE_PAGE_SIZE,
+        flags,
+        true,
+        OE_PAGE_SIZE));
 
     result = OE_OK;
 
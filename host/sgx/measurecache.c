@@ -0,0 +1,193 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "measurecache.h"
+#include <openenclave/host.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/utils.h>
+#include <string.h>
+#include "../hostthread.h"
+
+/*
+**==============================================================================
+**
+** Measurement cache
+**
+**     MRENCLAVE is a function of the pages added to the enclave and of their
+**     flags. These are fully determined by the patched enclave image, the
+**     properties the enclave is built with and the layout derived from them,
+**     but not by the base address of the enclave. The cache maps the SHA-256
+**     of those inputs to the MRENCLAVE computed when the enclave was first
+**     built, so that building the same enclave again in this process can
+**     skip measuring every page, including the heap and stack pages.
+**
+**     The cache only lives in the memory of the process: a digest that the
+**     signing tools did not compute themselves is never trusted. It holds a
+**     few entries and replaces them in round-robin order.
+**
+**==============================================================================
+*/
+
+#define MEASUREMENT_CACHE_SIZE 16
+
+typedef struct _measurement_cache_entry
+{
+    bool used;
+    OE_SHA256 key;
+    OE_SHA256 mrenclave;
+} measurement_cache_entry_t;
+
+static oe_mutex _lock = OE_H_MUTEX_INITIALIZER;
+static bool _enabled;
+static measurement_cache_entry_t _entries[MEASUREMENT_CACHE_SIZE];
+static size_t _next_entry;
+
+oe_result_t oe_enable_measurement_cache(bool enable)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (oe_mutex_lock(&_lock) != 0)
+        OE_RAISE(OE_FAILURE);
+
+    /* Disabling the cache also forgets the measurements it holds */
+    if (!enable)
+    {
+        memset(_entries, 0, sizeof(_entries));
+        _next_entry = 0;
+    }
+
+    _enabled = enable;
+    oe_mutex_unlock(&_lock);
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+bool oe_sgx_is_measurement_cache_enabled(void)
+{
+    bool enabled = false;
+
+    if (oe_mutex_lock(&_lock) == 0)
+    {
+        enabled = _enabled;
+        oe_mutex_unlock(&_lock);
+    }
+
+    return enabled;
+}
+
+static void _update_u64(oe_sha256_context_t* context, uint64_t value)
+{
+    oe_sha256_update(context, &value, sizeof(value));
+}
+
+oe_result_t oe_sgx_get_measurement_cache_key(
+    const oe_enclave_image_t* image,
+    const oe_sgx_enclave_properties_t* properties,
+    uint64_t attributes,
+    size_t enclave_size,
+    size_t tls_page_count,
+    OE_SHA256* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+    const oe_enclave_elf_image_t* elf;
+
+    if (!image || !properties || !key)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (image->type != OE_IMAGE_TYPE_ELF)
+        OE_RAISE(OE_UNSUPPORTED);
+
+    elf = &image->elf;
+
+    OE_CHECK(oe_sha256_init(&context));
+
+    /* The loaded segments, already patched for this enclave layout */
+    _update_u64(&context, elf->image_size);
+    OE_CHECK(oe_sha256_update(&context, elf->image_base, elf->image_size));
+
+    for (size_t i = 0; i < elf->num_segments; i++)
+    {
+        _update_u64(&context, elf->segments[i].vaddr);
+        _update_u64(&context, elf->segments[i].memsz);
+        _update_u64(&context, elf->segments[i].flags);
+    }
+
+    _update_u64(&context, elf->reloc_size);
+    if (elf->reloc_size)
+        OE_CHECK(oe_sha256_update(&context, elf->reloc_data, elf->reloc_size));
+
+    _update_u64(&context, elf->entry_rva);
+
+    /* The properties, except for the signature that is not measured */
+    OE_CHECK(oe_sha256_update(
+        &context,
+        properties,
+        OE_OFFSETOF(oe_sgx_enclave_properties_t, sigstruct)));
+
+    _update_u64(&context, attributes);
+    _update_u64(&context, enclave_size);
+    _update_u64(&context, tls_page_count);
+
+    OE_CHECK(oe_sha256_final(&context, key));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+bool oe_sgx_find_cached_measurement(const OE_SHA256* key, OE_SHA256* mrenclave)
+{
+    bool found = false;
+
+    if (oe_mutex_lock(&_lock) != 0)
+        return false;
+
+    for (size_t i = 0; _enabled && i < MEASUREMENT_CACHE_SIZE; i++)
+    {
+        if (_entries[i].used &&
+            memcmp(&_entries[i].key, key, sizeof(OE_SHA256)) == 0)
+        {
+            *mrenclave = _entries[i].mrenclave;
+            found = true;
+            break;
+        }
+    }
+
+    oe_mutex_unlock(&_lock);
+
+    return found;
+}
+
+void oe_sgx_add_cached_measurement(
+    const OE_SHA256* key,
+    const OE_SHA256* mrenclave)
+{
+    measurement_cache_entry_t* entry;
+
+    if (oe_mutex_lock(&_lock) != 0)
+        return;
+
+    if (!_enabled)
+        goto done;
+
+    /* Enclaves built concurrently may both have missed the cache */
+    for (size_t i = 0; i < MEASUREMENT_CACHE_SIZE; i++)
+    {
+        if (_entries[i].used &&
+            memcmp(&_entries[i].key, key, sizeof(OE_SHA256)) == 0)
+            goto done;
+    }
+
+    entry = &_entries[_next_entry];
+    entry->used = true;
+    entry->key = *key;
+    entry->mrenclave = *mrenclave;
+    _next_entry = (_next_entry + 1) % MEASUREMENT_CACHE_SIZE;
+
+done:
+    oe_mutex_unlock(&_lock);
+}
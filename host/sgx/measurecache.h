@@ -0,0 +1,36 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_MEASURECACHE_H
+#define _OE_MEASURECACHE_H
+
+#include <openenclave/bits/properties.h>
+#include <openenclave/internal/crypto/sha.h>
+#include <openenclave/internal/load.h>
+
+OE_EXTERNC_BEGIN
+
+/* Returns true if oe_enable_measurement_cache() enabled the cache */
+bool oe_sgx_is_measurement_cache_enabled(void);
+
+/* Compute the cache key of an enclave from its patched image, its final
+ * properties and the layout derived from them */
+oe_result_t oe_sgx_get_measurement_cache_key(
+    const oe_enclave_image_t* image,
+    const oe_sgx_enclave_properties_t* properties,
+    uint64_t attributes,
+    size_t enclave_size,
+    size_t tls_page_count,
+    OE_SHA256* key);
+
+/* Look up the MRENCLAVE of the given key; returns false on a miss */
+bool oe_sgx_find_cached_measurement(const OE_SHA256* key, OE_SHA256* mrenclave);
+
+/* Remember the MRENCLAVE of the given key */
+void oe_sgx_add_cached_measurement(
+    const OE_SHA256* key,
+    const OE_SHA256* mrenclave);
+
+OE_EXTERNC_END
+
+#endif /* _OE_MEASURECACHE_H */
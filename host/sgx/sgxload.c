@@ -514,6 +514,97 @@ static void _dump_load_enclave_data(
 
 #endif /* defined(OE_TRACE_MEASURE) */
 
+#if !defined(OEHOSTMR)
+
+static bool _is_zero_page(const void* page)
+{
+    const uint64_t* p = (const uint64_t*)page;
+
+    for (size_t i = 0; i < OE_PAGE_SIZE / sizeof(uint64_t); i++)
+    {
+        if (p[i])
+            return false;
+    }
+
+    return true;
+}
+
+/* Copy npages pages onto the simulated enclave and protect them. A zero
+ * src_stride loads the same source page into every page of the range. */
+static oe_result_t _simulate_load_enclave_pages(
+    oe_sgx_load_context_t* context,
+    uint64_t addr,
+    uint64_t src,
+    size_t npages,
+    uint64_t flags,
+    size_t src_stride)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t size;
+    uint64_t end;
+    uint64_t sim_end = (uint64_t)context->sim.addr + context->sim.size;
+    int prot;
+
+    /* Verify that the pages are within enclave boundaries */
+    if (oe_safe_mul_u64(npages, OE_PAGE_SIZE, &size) != OE_OK ||
+        oe_safe_add_u64(addr, size, &end) != OE_OK ||
+        addr < (uint64_t)context->sim.addr || end > sim_end)
+        OE_RAISE_MSG(
+            OE_FAILURE, "Page is NOT within enclave boundaries", NULL);
+
+    /* Copy page contents onto memory-mapped region. The region was freshly
+     * mapped by _allocate_enclave_memory() and each page is only loaded once,
+     * so a repeated zero page needs no copy at all. */
+    if (src_stride)
+    {
+        OE_CHECK(oe_memcpy_s(
+            (uint8_t*)addr, (size_t)size, (uint8_t*)src, (size_t)size));
+    }
+    else if (!_is_zero_page((const void*)src))
+    {
+        for (size_t i = 0; i < npages; i++)
+        {
+            OE_CHECK(oe_memcpy_s(
+                (uint8_t*)addr + i * OE_PAGE_SIZE,
+                OE_PAGE_SIZE,
+                (uint8_t*)src,
+                OE_PAGE_SIZE));
+        }
+    }
+
+    /* Set page access permissions for the whole range at once */
+    prot = _make_memory_protect_param(flags, true /*simulate*/);
+
+    if ((uint32_t)prot > OE_INT_MAX)
+        OE_RAISE_MSG(OE_FAILURE, "Unexpected page protections: %#x", prot);
+
+#if defined(__linux__)
+    if (mprotect((void*)addr, (size_t)size, prot) != 0)
+        OE_RAISE_MSG(
+            OE_FAILURE,
+            "mprotect failed (addr=%#x, size=%#x, prot=%#x)",
+            addr,
+            size,
+            prot);
+#elif defined(_WIN32)
+    DWORD old;
+    if (!VirtualProtect((LPVOID)addr, (SIZE_T)size, prot, &old))
+        OE_RAISE_MSG(
+            OE_FAILURE,
+            "VirtualProtect failed (addr=%#x, size=%#x, prot=%#x)",
+            addr,
+            size,
+            prot);
+#endif
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+#endif // OEHOSTMR
+
 oe_result_t oe_sgx_load_enclave_data(
     oe_sgx_load_context_t* context,
     uint64_t base,
@@ -540,9 +631,10 @@ oe_result_t oe_sgx_load_enclave_data(
 
 #endif /* defined(OE_TRACE_MEASURE) */
 
-    /* Measure this operation */
-    OE_CHECK(oe_sgx_measure_load_enclave_data(
-        &context->hash_context, base, addr, src, flags, extend));
+    /* Measure this operation unless MRENCLAVE is already known */
+    if (!context->use_cached_mrenclave)
+        OE_CHECK(oe_sgx_measure_load_enclave_data(
+            &context->hash_context, base, addr, src, flags, extend));
 
     if (context->type == OE_SGX_LOAD_TYPE_MEASURE)
     {
@@ -554,42 +646,8 @@ oe_result_t oe_sgx_load_enclave_data(
     else if (oe_sgx_is_simulation_load_context(context))
     {
         /* Simulate enclave add page */
-        /* Verify that page is within enclave boundaries */
-        if ((void*)addr < context->sim.addr ||
-            (uint8_t*)addr >
-                (uint8_t*)context->sim.addr + context->sim.size - OE_PAGE_SIZE)
-            OE_RAISE_MSG(
-                OE_FAILURE, "Page is NOT within enclave boundaries", NULL);
-
-        /* Copy page contents onto memory-mapped region */
-        OE_CHECK(oe_memcpy_s(
-            (uint8_t*)addr, OE_PAGE_SIZE, (uint8_t*)src, OE_PAGE_SIZE));
-
-        /* Set page access permissions */
-        {
-            int prot = _make_memory_protect_param(flags, true /*simulate*/);
-
-            if ((uint32_t)prot > OE_INT_MAX)
-                OE_RAISE_MSG(
-                    OE_FAILURE, "Unexpected page protections: %#x", prot);
-
-#if defined(__linux__)
-            if (mprotect((void*)addr, OE_PAGE_SIZE, prot) != 0)
-                OE_RAISE_MSG(
-                    OE_FAILURE,
-                    "mprotect failed (addr=%#x, prot=%#x)",
-                    addr,
-                    prot);
-#elif defined(_WIN32)
-            DWORD old;
-            if (!VirtualProtect((LPVOID)addr, OE_PAGE_SIZE, prot, &old))
-                OE_RAISE_MSG(
-                    OE_FAILURE,
-                    "VirtualProtect failed (addr=%#x, prot=%#x)",
-                    addr,
-                    prot);
-#endif
-        }
+        OE_CHECK(_simulate_load_enclave_pages(
+            context, addr, src, 1, flags, OE_PAGE_SIZE));
     }
     else
     {
@@ -619,6 +677,86 @@ done:
     return result;
 }
 
+oe_result_t oe_sgx_load_enclave_pages(
+    oe_sgx_load_context_t* context,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    size_t npages,
+    uint64_t flags,
+    bool extend,
+    size_t src_stride)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!context || !base || !addr || !src || !flags)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (src_stride != 0 && src_stride != OE_PAGE_SIZE)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+#if !defined(OEHOSTMR)
+    if (oe_sgx_is_simulation_load_context(context))
+    {
+        if (context->state != OE_SGX_LOAD_STATE_ENCLAVE_CREATED)
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        /* addr and src must both be page aligned */
+        if (addr % OE_PAGE_SIZE || src % OE_PAGE_SIZE)
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        if (npages == 0)
+        {
+            result = OE_OK;
+            goto done;
+        }
+
+        /* MRENCLAVE is still extended one page at a time */
+        for (size_t i = 0; !context->use_cached_mrenclave && i < npages; i++)
+        {
+            uint64_t page_addr = addr + i * OE_PAGE_SIZE;
+            uint64_t page_src = src + i * src_stride;
+
+#if defined(OE_TRACE_MEASURE)
+            _dump_load_enclave_data(page_addr - base, flags, page_src, extend);
+#endif /* defined(OE_TRACE_MEASURE) */
+
+            OE_CHECK(oe_sgx_measure_load_enclave_data(
+                &context->hash_context,
+                base,
+                page_addr,
+                page_src,
+                flags,
+                extend));
+        }
+
+        /* Coalesce the copy and the protection change of the range */
+        OE_CHECK(_simulate_load_enclave_pages(
+            context, addr, src, npages, flags, src_stride));
+
+        result = OE_OK;
+        goto done;
+    }
+#endif // OEHOSTMR
+
+    /* EADD works on a single page, so add the range page by page */
+    for (size_t i = 0; i < npages; i++)
+    {
+        OE_CHECK(oe_sgx_load_enclave_data(
+            context,
+            base,
+            addr + i * OE_PAGE_SIZE,
+            src + i * src_stride,
+            flags,
+            extend));
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 oe_result_t oe_sgx_initialize_enclave(
     oe_sgx_load_context_t* context,
     uint64_t addr,
@@ -639,6 +777,10 @@ oe_result_t oe_sgx_initialize_enclave(
     /* Measure this operation */
     OE_CHECK(
         oe_sgx_measure_initialize_enclave(&context->hash_context, mrenclave));
+
+    /* The hash is incomplete when the pages were not measured */
+    if (context->use_cached_mrenclave)
+        *mrenclave = context->cached_mrenclave;
 #if !defined(OEHOSTMR)
     /* EINIT has no further action in measurement/simulation mode */
     if (context->type == OE_SGX_LOAD_TYPE_CREATE &&
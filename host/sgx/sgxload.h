@@ -41,6 +41,20 @@ oe_result_t oe_sgx_load_enclave_data(
     uint64_t flags,
     bool extend);
 
+/* Load npages consecutive pages with the same flags. Pages are measured one
+ * at a time, but in simulation mode the whole range is copied and protected
+ * at once. src_stride is OE_PAGE_SIZE to load consecutive source pages, or 0
+ * to load the same source page into every enclave page. */
+oe_result_t oe_sgx_load_enclave_pages(
+    oe_sgx_load_context_t* context,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    size_t npages,
+    uint64_t flags,
+    bool extend,
+    size_t src_stride);
+
 oe_result_t oe_sgx_initialize_enclave(
     oe_sgx_load_context_t* context,
     uint64_t addr,
@@ -0,0 +1,114 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/raise.h>
+#include "enclave.h"
+#include "platform_u.h"
+
+/**
+ * Declare the prototypes of the following functions to avoid missing-prototypes
+ * warning.
+ */
+OE_UNUSED_FUNC oe_result_t _oe_sgx_register_shared_memory_ecall(
+    oe_enclave_t* enclave,
+    oe_result_t* _retval,
+    void* address,
+    size_t size,
+    uint64_t* region_id);
+OE_UNUSED_FUNC oe_result_t _oe_sgx_unregister_shared_memory_ecall(
+    oe_enclave_t* enclave,
+    oe_result_t* _retval,
+    uint64_t region_id);
+
+/**
+ * Make the following ECALLs weak to support the system EDL opt-in.
+ * When the user does not opt into (import) the EDL, the linker will pick
+ * the following default implementations. If the user opts into the EDL,
+ * the implementions (which are also weak) in the oeedger8r-generated code will
+ * be used. This behavior is guaranteed by the linker; i.e., the linker will
+ * pick the symbols defined in the object before those in the library.
+ */
+oe_result_t _oe_sgx_register_shared_memory_ecall(
+    oe_enclave_t* enclave,
+    oe_result_t* _retval,
+    void* address,
+    size_t size,
+    uint64_t* region_id)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(address);
+    OE_UNUSED(size);
+    OE_UNUSED(region_id);
+
+    if (_retval)
+        *_retval = OE_UNSUPPORTED;
+
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(
+    _oe_sgx_register_shared_memory_ecall,
+    oe_sgx_register_shared_memory_ecall);
+
+oe_result_t _oe_sgx_unregister_shared_memory_ecall(
+    oe_enclave_t* enclave,
+    oe_result_t* _retval,
+    uint64_t region_id)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(region_id);
+
+    if (_retval)
+        *_retval = OE_UNSUPPORTED;
+
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(
+    _oe_sgx_unregister_shared_memory_ecall,
+    oe_sgx_unregister_shared_memory_ecall);
+
+oe_result_t oe_register_shared_memory(
+    oe_enclave_t* enclave,
+    void* address,
+    size_t size,
+    uint64_t* region_id)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t retval = OE_UNEXPECTED;
+
+    if (region_id)
+        *region_id = 0;
+
+    if (!enclave || !address || !size || !region_id)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_sgx_register_shared_memory_ecall(
+        enclave, &retval, address, size, region_id));
+    OE_CHECK(retval);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_unregister_shared_memory(
+    oe_enclave_t* enclave,
+    uint64_t region_id)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t retval = OE_UNEXPECTED;
+
+    if (!enclave)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(
+        oe_sgx_unregister_shared_memory_ecall(enclave, &retval, region_id));
+    OE_CHECK(retval);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
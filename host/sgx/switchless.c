@@ -23,6 +23,20 @@
  */
 #define OE_ENCLAVE_WORKER_SPIN_COUNT_THRESHOLD (4096U)
 
+/**
+ * Default interval between two adjustments of elastic worker pools
+ */
+#define OE_SWITCHLESS_DEFAULT_ADJUST_INTERVAL_MSEC (10U)
+
+/**
+ * Percentage of missed calls above which an elastic worker pool grows
+ */
+#define OE_SWITCHLESS_MISSED_CALL_PERCENT_THRESHOLD (1U)
+
+// The default time (in microseconds) a host thread spins on a switchless
+// ecall before blocking. It covers a couple of regular ECALL round trips.
+#define OE_SWITCHLESS_DEFAULT_ECALL_SPIN_BUDGET_USEC (50U)
+
 /**
  * Declare the prototypes of the following functions to avoid missing-prototypes
  * warning.
@@ -75,6 +89,85 @@ OE_WEAK_ALIAS(
     _oe_sgx_switchless_enclave_worker_thread_ecall,
     oe_sgx_switchless_enclave_worker_thread_ecall);
 
+/*
+** Atomically add value to *x.
+*/
+static void _atomic_add(volatile uint64_t* x, uint64_t value)
+{
+    uint64_t old;
+
+    do
+    {
+        old = oe_atomic_load(x);
+    } while (!oe_atomic_compare_and_swap(
+        (volatile int64_t*)x, (int64_t)old, (int64_t)(old + value)));
+}
+
+/*
+** Return the call at the head of the worker's request ring, or NULL if the
+** ring is empty. The slot stays occupied until _release_ring_head is called so
+** that enclave threads can tell a busy worker from an idle one.
+*/
+static volatile oe_call_host_function_args_t* _peek_ring_head(
+    oe_host_worker_context_t* context)
+{
+    uint64_t head = context->ring_head;
+    volatile oe_switchless_call_slot_t* slot =
+        &context->ring[head & (OE_SWITCHLESS_RING_SIZE - 1)];
+
+    // A producer publishes a slot by advancing its sequence to head + 1 after
+    // having written call_arg.
+    if (oe_atomic_load(&slot->sequence) != head + 1)
+        return NULL;
+
+    OE_ATOMIC_MEMORY_BARRIER_ACQUIRE();
+    return (volatile oe_call_host_function_args_t*)slot->call_arg;
+}
+
+/*
+** Hand the slot at the head of the worker's request ring back to producers.
+*/
+static void _release_ring_head(oe_host_worker_context_t* context)
+{
+    uint64_t head = context->ring_head;
+    volatile oe_switchless_call_slot_t* slot =
+        &context->ring[head & (OE_SWITCHLESS_RING_SIZE - 1)];
+
+    slot->call_arg = NULL;
+    context->ring_head = head + 1;
+
+    // Producers may claim the slot again on their next lap around the ring.
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    slot->sequence = head + OE_SWITCHLESS_RING_SIZE;
+}
+
+/*
+** Record the time at which the worker first saw the calls that were queued in
+** its ring while it was busy, and return the new end of the recorded calls.
+*/
+static uint64_t _record_queued_calls(
+    oe_host_worker_context_t* context,
+    uint64_t* seen_time,
+    uint64_t seen_tail,
+    uint64_t now)
+{
+    uint64_t head = context->ring_head;
+    uint64_t tail = oe_atomic_load(&context->ring_tail);
+
+    // The tail is written by enclave threads. Only consider one lap of the
+    // ring.
+    if (tail - head > OE_SWITCHLESS_RING_SIZE)
+        tail = head + OE_SWITCHLESS_RING_SIZE;
+
+    if (seen_tail < head)
+        seen_tail = head;
+
+    for (; seen_tail < tail; seen_tail++)
+        seen_time[seen_tail & (OE_SWITCHLESS_RING_SIZE - 1)] = now;
+
+    return seen_tail;
+}
+
 /*
 ** The thread function that handles switchless ocalls
 **
@@ -83,21 +176,50 @@ static void* _switchless_ocall_worker(void* arg)
 {
     oe_host_worker_context_t* context = (oe_host_worker_context_t*)arg;
 
+    // Time at which the worker started spinning, or 0 while it is busy.
+    uint64_t spin_start_time = oe_switchless_get_time();
+
+    // Time at which the worker first saw each of the calls in
+    // [ring_head, seen_tail), which were queued behind other calls.
+    uint64_t seen_time[OE_SWITCHLESS_RING_SIZE] = {0};
+    uint64_t seen_tail = 0;
+
     while (!context->is_stopping)
     {
         volatile oe_call_host_function_args_t* local_call_arg = NULL;
-        if ((local_call_arg = context->call_arg) != NULL)
+        if ((local_call_arg = _peek_ring_head(context)) != NULL)
         {
-            // Handle the switchless call, but do not clear the slot yet. Since
-            // the slot is not empty, any new incoming switchless call request
-            // will be scheduled in another available work thread and get
-            // handled immediately.
+            uint64_t start_time = oe_switchless_get_time();
+            uint64_t head = context->ring_head;
+
+            if (spin_start_time)
+            {
+                context->spin_time += start_time - spin_start_time;
+                spin_start_time = 0;
+            }
+            else if (head < seen_tail)
+            {
+                context->queue_time +=
+                    start_time -
+                    seen_time[head & (OE_SWITCHLESS_RING_SIZE - 1)];
+            }
+
+            // Handle the switchless call, but do not release the slot yet.
+            // Since the ring is not empty, new incoming switchless call
+            // requests will preferably be scheduled in an idle worker thread.
             oe_handle_call_host_function(
                 (uint64_t)local_call_arg, context->enc);
 
-            // After handling the switchless call, mark this worker thread
-            // as free by clearing the slot.
-            context->call_arg = NULL;
+            // After handling the switchless call, release the slot so that
+            // the next queued request (if any) is handled back to back.
+            _release_ring_head(context);
+
+            // Account the call for telemetry and the elastic pool monitor.
+            uint64_t end_time = oe_switchless_get_time();
+            context->call_count++;
+            context->busy_time += end_time - start_time;
+            seen_tail =
+                _record_queued_calls(context, seen_time, seen_tail, end_time);
 
             // Reset spin count for next message.
             context->total_spin_count += context->spin_count;
@@ -105,14 +227,25 @@ static void* _switchless_ocall_worker(void* arg)
         }
         else
         {
+            if (!spin_start_time)
+                spin_start_time = oe_switchless_get_time();
+
             // If there is no message, increment spin count until threshold is
-            // reached.
-            if (++context->spin_count >= OE_HOST_WORKER_SPIN_COUNT_THRESHOLD)
+            // reached. A worker retired from an elastic pool goes to sleep as
+            // soon as its ring is drained.
+            if (++context->spin_count >= OE_HOST_WORKER_SPIN_COUNT_THRESHOLD ||
+                !context->is_active)
             {
+                uint64_t sleep_start_time = oe_switchless_get_time();
+                context->spin_time += sleep_start_time - spin_start_time;
+
                 // Reset spin count and go to sleep until event is fired.
                 context->total_spin_count += context->spin_count;
                 context->spin_count = 0;
                 oe_host_worker_wait(context);
+
+                spin_start_time = oe_switchless_get_time();
+                context->sleep_time += spin_start_time - sleep_start_time;
             }
 
             /* Yield CPU */
@@ -124,8 +257,12 @@ static void* _switchless_ocall_worker(void* arg)
 
 void oe_sgx_sleep_switchless_worker_ocall(oe_enclave_worker_context_t* context)
 {
+    uint64_t sleep_start_time = oe_switchless_get_time();
+
     // Wait for messages.
     oe_enclave_worker_wait(context);
+
+    context->sleep_time += oe_switchless_get_time() - sleep_start_time;
 }
 
 /*
@@ -146,9 +283,178 @@ static void* _switchless_ecall_worker(void* arg)
     return NULL;
 }
 
+/*
+** Return the number of active workers that an elastic pool should have, given
+** its load since the last adjustment.
+*/
+static size_t _get_target_worker_count(
+    const oe_switchless_pool_t* pool,
+    size_t max_workers,
+    const oe_switchless_pool_load_t* load,
+    uint64_t now,
+    uint32_t target_utilization)
+{
+    size_t num_active = pool->num_active_workers;
+    uint64_t elapsed = now - pool->last_time;
+    uint64_t calls = load->call_count - pool->last_load.call_count;
+    uint64_t missed = load->missed_count - pool->last_load.missed_count;
+    uint64_t busy = load->busy_time - pool->last_load.busy_time;
+
+    if (elapsed == 0)
+        return num_active;
+
+    // Add a worker if calls fell back to regular calls because all the
+    // workers were busy, or if the active workers are busier than targeted.
+    if (num_active < max_workers &&
+        (missed * 100 >
+             (calls + missed) * OE_SWITCHLESS_MISSED_CALL_PERCENT_THRESHOLD ||
+         busy * 100 > num_active * elapsed * target_utilization))
+        return num_active + 1;
+
+    // Retire a worker if the remaining ones would still be below the target,
+    // i.e. if the active workers mostly spin or sleep.
+    if (num_active > pool->min_workers && missed == 0 &&
+        busy * 100 < (num_active - 1) * elapsed * target_utilization)
+        return num_active - 1;
+
+    return num_active;
+}
+
+static void _adjust_host_worker_pool(oe_switchless_call_manager_t* manager)
+{
+    oe_switchless_pool_t* pool = &manager->host_worker_pool;
+    oe_switchless_pool_load_t load = {0};
+    uint64_t now = oe_switchless_get_time();
+    size_t num_active;
+
+    for (size_t i = 0; i < manager->num_host_workers; i++)
+    {
+        oe_host_worker_context_t* context = &manager->host_worker_contexts[i];
+        load.call_count += oe_atomic_load(&context->call_count);
+        load.missed_count += oe_atomic_load(&context->missed_count);
+        load.busy_time += oe_atomic_load(&context->busy_time);
+    }
+
+    num_active = _get_target_worker_count(
+        pool,
+        manager->num_host_workers,
+        &load,
+        now,
+        manager->target_utilization);
+
+    if (num_active > pool->num_active_workers)
+    {
+        oe_host_worker_context_t* context =
+            &manager->host_worker_contexts[pool->num_active_workers];
+
+        OE_TRACE_INFO(
+            "Activating switchless host worker thread %d\n",
+            (int)pool->num_active_workers);
+        OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+        context->is_active = true;
+        oe_host_worker_wake(context);
+    }
+    else if (num_active < pool->num_active_workers)
+    {
+        // The worker handles the calls that are already queued in its ring
+        // and then goes to sleep.
+        OE_TRACE_INFO(
+            "Retiring switchless host worker thread %d\n", (int)num_active);
+        manager->host_worker_contexts[num_active].is_active = false;
+    }
+
+    pool->num_active_workers = num_active;
+    pool->last_load = load;
+    pool->last_time = now;
+}
+
+static void _adjust_enclave_worker_pool(oe_switchless_call_manager_t* manager)
+{
+    oe_switchless_pool_t* pool = &manager->enclave_worker_pool;
+    oe_switchless_pool_load_t load = {0};
+    uint64_t now = oe_switchless_get_time();
+    size_t num_active;
+
+    for (size_t i = 0; i < manager->num_enclave_workers; i++)
+    {
+        oe_enclave_worker_context_t* context =
+            &manager->enclave_worker_contexts[i];
+        load.call_count += oe_atomic_load(&context->call_count);
+        load.missed_count += oe_atomic_load(&context->missed_count);
+        load.busy_time += oe_atomic_load(&context->busy_time);
+    }
+
+    num_active = _get_target_worker_count(
+        pool,
+        manager->num_enclave_workers,
+        &load,
+        now,
+        manager->target_utilization);
+
+    // An enclave worker that is not handed calls goes back to sleep on its
+    // own once it reaches its spin count threshold, and a posted call wakes
+    // it up. Toggling is_active is therefore enough.
+    if (num_active > pool->num_active_workers)
+    {
+        OE_TRACE_INFO(
+            "Activating switchless enclave worker thread %d\n",
+            (int)pool->num_active_workers);
+        manager->enclave_worker_contexts[pool->num_active_workers].is_active =
+            true;
+    }
+    else if (num_active < pool->num_active_workers)
+    {
+        OE_TRACE_INFO(
+            "Retiring switchless enclave worker thread %d\n",
+            (int)num_active);
+        manager->enclave_worker_contexts[num_active].is_active = false;
+    }
+
+    pool->num_active_workers = num_active;
+    pool->last_load = load;
+    pool->last_time = now;
+}
+
+/*
+** The thread function that periodically resizes elastic worker pools
+**
+*/
+static void* _switchless_monitor(void* arg)
+{
+    oe_switchless_call_manager_t* manager = (oe_switchless_call_manager_t*)arg;
+
+    while (true)
+    {
+        oe_switchless_monitor_wait(manager, manager->adjust_interval_msec);
+
+        if (manager->is_monitor_stopping)
+            break;
+
+        if (manager->host_worker_pool.min_workers < manager->num_host_workers)
+            _adjust_host_worker_pool(manager);
+
+        if (manager->enclave_worker_pool.min_workers <
+            manager->num_enclave_workers)
+            _adjust_enclave_worker_pool(manager);
+    }
+
+    return NULL;
+}
+
 static oe_result_t oe_stop_worker_threads(oe_switchless_call_manager_t* manager)
 {
     oe_result_t result = OE_UNEXPECTED;
+
+    // Stop resizing the pools first.
+    if (manager->monitor_thread != (oe_thread_t)NULL)
+    {
+        manager->is_monitor_stopping = true;
+        oe_switchless_monitor_wake(manager);
+        if (oe_thread_join(manager->monitor_thread))
+            OE_RAISE(OE_THREAD_JOIN_ERROR);
+        manager->monitor_thread = (oe_thread_t)NULL;
+    }
+
     for (size_t i = 0; i < manager->num_host_workers; i++)
     {
         manager->host_worker_contexts[i].is_stopping = true;
@@ -184,11 +490,74 @@ done:
     return result;
 }
 
+/*
+** Allocate zeroed worker contexts on page boundaries, preferably on the given
+** NUMA node. The contexts are padded to whole cache lines, so no two workers
+** share a cache line.
+*/
+static void* _allocate_worker_contexts(
+    size_t count,
+    size_t size,
+    int32_t numa_node)
+{
+    return oe_switchless_allocate_contexts(
+        (count ? count : 1) * size, numa_node);
+}
+
+static void _free_worker_contexts(void* contexts, size_t count, size_t size)
+{
+    oe_switchless_free_contexts(contexts, (count ? count : 1) * size);
+}
+
+/*
+** Pin worker i to the CPU the placement assigns it, if any. Like the NUMA
+** node of the contexts, the CPU is a preference: a worker that cannot be
+** pinned still serves calls, so the failure is only traced.
+*/
+static void _pin_worker(
+    oe_thread_t thread,
+    size_t index,
+    const uint32_t* cpus,
+    size_t cpu_count)
+{
+    if (cpus == NULL || cpu_count == 0)
+        return;
+
+    if (oe_switchless_set_thread_affinity(thread, cpus[index % cpu_count]) !=
+        OE_OK)
+    {
+        OE_TRACE_WARNING("Switchless worker %d runs unpinned\n", (int)index);
+    }
+}
+
 oe_result_t oe_start_switchless_manager(
     oe_enclave_t* enclave,
     size_t num_host_workers,
     size_t num_enclave_workers)
 {
+    // A fixed-size pool is an elastic pool whose min and max are equal.
+    oe_enclave_setting_context_switchless_elastic_t setting = {
+        .min_host_workers = num_host_workers,
+        .max_host_workers = num_host_workers,
+        .min_enclave_workers = num_enclave_workers,
+        .max_enclave_workers = num_enclave_workers,
+        .target_utilization = 100,
+        .adjust_interval_msec = 0};
+
+    return oe_start_elastic_switchless_manager(enclave, &setting, NULL);
+}
+
+oe_result_t oe_start_elastic_switchless_manager(
+    oe_enclave_t* enclave,
+    const oe_enclave_setting_context_switchless_elastic_t* setting,
+    const oe_enclave_setting_context_switchless_placement_t* placement)
+{
+    // By default, the workers are not pinned and the contexts go anywhere.
+    static const oe_enclave_setting_context_switchless_placement_t
+        default_placement = {
+            .host_worker_numa_node = OE_SWITCHLESS_NUMA_NODE_ANY,
+            .enclave_worker_numa_node = OE_SWITCHLESS_NUMA_NODE_ANY};
+
     oe_result_t result = OE_UNEXPECTED;
     oe_result_t result_out = 0;
     oe_switchless_call_manager_t* manager = NULL;
@@ -196,16 +565,33 @@ oe_result_t oe_start_switchless_manager(
     oe_thread_t* host_threads = NULL;
     oe_enclave_worker_context_t* enclave_contexts = NULL;
     oe_thread_t* enclave_threads = NULL;
+    size_t num_host_workers = 0;
+    size_t num_enclave_workers = 0;
+    size_t min_host_workers = 0;
+    size_t min_enclave_workers = 0;
 
-    if (enclave == NULL)
+    if (enclave == NULL || setting == NULL)
         OE_RAISE(OE_INVALID_PARAMETER);
 
     if (enclave->switchless_manager != NULL)
         OE_RAISE(OE_UNEXPECTED);
 
+    if (placement == NULL)
+        placement = &default_placement;
+
+    num_host_workers = setting->max_host_workers;
+    num_enclave_workers = setting->max_enclave_workers;
+    min_host_workers = setting->min_host_workers;
+    min_enclave_workers = setting->min_enclave_workers;
+
     if (num_host_workers == 0 && num_enclave_workers == 0)
         OE_RAISE(OE_UNEXPECTED);
 
+    if (min_host_workers > num_host_workers ||
+        min_enclave_workers > num_enclave_workers ||
+        setting->target_utilization == 0 || setting->target_utilization > 100)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
     // Limit the number of workers to the number of thread bindings
     // because the maximum parallelism is dictated by the latter for
     // synchronous ocalls. We may need to revisit this for asynchronous
@@ -216,12 +602,30 @@ oe_result_t oe_start_switchless_manager(
     if (num_enclave_workers > enclave->num_bindings)
         num_enclave_workers = (uint32_t)enclave->num_bindings;
 
+    // Keep at least one worker of each pool active so that the misses that
+    // make a pool grow get counted.
+    if (min_host_workers > num_host_workers)
+        min_host_workers = num_host_workers;
+    else if (min_host_workers == 0 && num_host_workers > 0)
+        min_host_workers = 1;
+
+    if (min_enclave_workers > num_enclave_workers)
+        min_enclave_workers = num_enclave_workers;
+    else if (min_enclave_workers == 0 && num_enclave_workers > 0)
+        min_enclave_workers = 1;
+
     // Allocate memory for the manager and its arrays
     manager = calloc(1, sizeof(oe_switchless_call_manager_t));
     if (manager == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
-    host_contexts = calloc(num_host_workers, sizeof(oe_host_worker_context_t));
+    // The host worker contexts are polled by the workers and written by the
+    // enclave threads making ocalls, the enclave worker contexts the other
+    // way around, so each set goes to the node the placement asks for.
+    host_contexts = _allocate_worker_contexts(
+        num_host_workers,
+        sizeof(oe_host_worker_context_t),
+        placement->host_worker_numa_node);
     if (host_contexts == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
@@ -229,8 +633,10 @@ oe_result_t oe_start_switchless_manager(
     if (host_threads == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
-    enclave_contexts =
-        calloc(num_enclave_workers, sizeof(oe_enclave_worker_context_t));
+    enclave_contexts = _allocate_worker_contexts(
+        num_enclave_workers,
+        sizeof(oe_enclave_worker_context_t),
+        placement->enclave_worker_numa_node);
     if (enclave_contexts == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
@@ -244,12 +650,31 @@ oe_result_t oe_start_switchless_manager(
     manager->num_enclave_workers = num_enclave_workers;
     manager->enclave_worker_contexts = enclave_contexts;
     manager->enclave_worker_threads = enclave_threads;
+    manager->host_worker_pool.min_workers = min_host_workers;
+    manager->host_worker_pool.num_active_workers = min_host_workers;
+    manager->enclave_worker_pool.min_workers = min_enclave_workers;
+    manager->enclave_worker_pool.num_active_workers = min_enclave_workers;
+    manager->target_utilization = setting->target_utilization;
+    manager->start_time = oe_switchless_get_time();
+    manager->ecall_spin_budget =
+        OE_SWITCHLESS_DEFAULT_ECALL_SPIN_BUDGET_USEC * 1000;
+    manager->adjust_interval_msec = setting->adjust_interval_msec;
+    if (manager->adjust_interval_msec == 0)
+        manager->adjust_interval_msec =
+            OE_SWITCHLESS_DEFAULT_ADJUST_INTERVAL_MSEC;
 
     // Start the host worker threads, and assign each one a private context.
     for (size_t i = 0; i < num_host_workers; i++)
     {
         OE_TRACE_INFO("Creating switchless host worker thread %d\n", (int)i);
         manager->host_worker_contexts[i].enc = enclave;
+        manager->host_worker_contexts[i].is_active = (i < min_host_workers);
+
+        // Slot j of the ring is first claimed by the producer holding ticket
+        // j.
+        for (size_t j = 0; j < OE_SWITCHLESS_RING_SIZE; j++)
+            manager->host_worker_contexts[i].ring[j].sequence = j;
+
         if (oe_thread_create(
                 &manager->host_worker_threads[i],
                 _switchless_ocall_worker,
@@ -257,6 +682,12 @@ oe_result_t oe_start_switchless_manager(
         {
             OE_RAISE(OE_THREAD_CREATE_ERROR);
         }
+
+        _pin_worker(
+            manager->host_worker_threads[i],
+            i,
+            placement->host_worker_cpus,
+            placement->host_worker_cpu_count);
     }
 
     // Inform the enclave about the switchless manager through an ECALL
@@ -279,6 +710,8 @@ oe_result_t oe_start_switchless_manager(
         manager->enclave_worker_contexts[i].enc = enclave;
         manager->enclave_worker_contexts[i].spin_count_threshold =
             OE_ENCLAVE_WORKER_SPIN_COUNT_THRESHOLD;
+        manager->enclave_worker_contexts[i].is_active =
+            (i < min_enclave_workers);
         if (oe_thread_create(
                 &manager->enclave_worker_threads[i],
                 _switchless_ecall_worker,
@@ -287,6 +720,14 @@ oe_result_t oe_start_switchless_manager(
             OE_RAISE(OE_THREAD_CREATE_ERROR);
         }
 
+        // The enclave worker runs on the host thread that entered the
+        // enclave, so pinning that thread pins the worker.
+        _pin_worker(
+            manager->enclave_worker_threads[i],
+            i,
+            placement->enclave_worker_cpus,
+            placement->enclave_worker_cpu_count);
+
         // Wait until the enclave worker thread has started.
         // If so, spin_count and/or total_spin_count will be non zero.
         // This ensures that each ecall worker thread has a dedicated tcs.
@@ -298,6 +739,21 @@ oe_result_t oe_start_switchless_manager(
         }
     }
 
+    // Start resizing the pools that are elastic.
+    if (min_host_workers < num_host_workers ||
+        min_enclave_workers < num_enclave_workers)
+    {
+        uint64_t now = oe_switchless_get_time();
+        manager->host_worker_pool.last_time = now;
+        manager->enclave_worker_pool.last_time = now;
+
+        if (oe_thread_create(
+                &manager->monitor_thread, _switchless_monitor, manager) != 0)
+        {
+            OE_RAISE(OE_THREAD_CREATE_ERROR);
+        }
+    }
+
     // Each enclave has at most one switchless manager.
     enclave->switchless_manager = manager;
 
@@ -331,11 +787,17 @@ oe_result_t oe_stop_switchless_manager(oe_enclave_t* enclave)
 
         // Free all allocated buffers.
         if (manager->host_worker_contexts != NULL)
-            free(manager->host_worker_contexts);
+            _free_worker_contexts(
+                manager->host_worker_contexts,
+                manager->num_host_workers,
+                sizeof(oe_host_worker_context_t));
         if (manager->host_worker_threads != NULL)
             free(manager->host_worker_threads);
         if (manager->enclave_worker_contexts != NULL)
-            free(manager->enclave_worker_contexts);
+            _free_worker_contexts(
+                manager->enclave_worker_contexts,
+                manager->num_enclave_workers,
+                sizeof(oe_enclave_worker_context_t));
         if (manager->enclave_worker_threads != NULL)
             free(manager->enclave_worker_threads);
         free(manager);
@@ -347,9 +809,273 @@ done:
 
 void oe_sgx_wake_switchless_worker_ocall(oe_host_worker_context_t* context)
 {
+    oe_atomic_increment(&context->wake_count);
     oe_host_worker_wake(context);
 }
 
+void oe_sgx_wake_switchless_caller_ocall(oe_enclave_worker_context_t* context)
+{
+    oe_switchless_caller_wake(context);
+}
+
+/*
+**==============================================================================
+**
+** Switchless call telemetry
+**
+** The counters are maintained in the worker contexts, mostly by the host
+** threads that own them. They are read here without stopping the workers.
+**
+**==============================================================================
+*/
+
+static void _get_host_worker_statistics(
+    oe_host_worker_context_t* context,
+    oe_switchless_worker_statistics_t* statistics)
+{
+    statistics->call_count = oe_atomic_load(&context->call_count);
+    statistics->missed_count = oe_atomic_load(&context->missed_count);
+    statistics->wake_count = oe_atomic_load(&context->wake_count);
+    statistics->busy_time = oe_atomic_load(&context->busy_time);
+    statistics->spin_time = oe_atomic_load(&context->spin_time);
+    statistics->sleep_time = oe_atomic_load(&context->sleep_time);
+    statistics->queue_time = oe_atomic_load(&context->queue_time);
+}
+
+static void _get_enclave_worker_statistics(
+    oe_switchless_call_manager_t* manager,
+    oe_enclave_worker_context_t* context,
+    uint64_t now,
+    oe_switchless_worker_statistics_t* statistics)
+{
+    uint64_t elapsed = now - manager->start_time;
+    uint64_t busy_time = oe_atomic_load(&context->busy_time);
+    uint64_t sleep_time = oe_atomic_load(&context->sleep_time);
+
+    statistics->call_count = oe_atomic_load(&context->call_count);
+    statistics->missed_count = oe_atomic_load(&context->missed_count);
+    statistics->wake_count = oe_atomic_load(&context->wake_count);
+    statistics->busy_time = busy_time;
+    statistics->sleep_time = sleep_time;
+    statistics->queue_time = 0;
+
+    // Enclave workers spin inside the enclave, where they cannot be timed.
+    // Account the time they were neither busy nor sleeping as spinning.
+    statistics->spin_time = (busy_time + sleep_time < elapsed)
+                                ? elapsed - busy_time - sleep_time
+                                : 0;
+}
+
+static void _add_worker_statistics(
+    oe_switchless_worker_statistics_t* sum,
+    const oe_switchless_worker_statistics_t* statistics)
+{
+    sum->call_count += statistics->call_count;
+    sum->missed_count += statistics->missed_count;
+    sum->wake_count += statistics->wake_count;
+    sum->busy_time += statistics->busy_time;
+    sum->spin_time += statistics->spin_time;
+    sum->sleep_time += statistics->sleep_time;
+    sum->queue_time += statistics->queue_time;
+}
+
+oe_result_t oe_get_switchless_statistics(
+    oe_enclave_t* enclave,
+    oe_switchless_statistics_t* statistics)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_switchless_call_manager_t* manager = NULL;
+    oe_switchless_worker_statistics_t worker_statistics;
+    uint64_t now = oe_switchless_get_time();
+
+    if (enclave == NULL || statistics == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if ((manager = enclave->switchless_manager) == NULL)
+        OE_RAISE_NO_TRACE(OE_NOT_FOUND);
+
+    memset(statistics, 0, sizeof(*statistics));
+
+    statistics->num_host_workers = manager->num_host_workers;
+    statistics->num_active_host_workers =
+        manager->host_worker_pool.num_active_workers;
+    for (size_t i = 0; i < manager->num_host_workers; i++)
+    {
+        _get_host_worker_statistics(
+            &manager->host_worker_contexts[i], &worker_statistics);
+        _add_worker_statistics(&statistics->host_workers, &worker_statistics);
+    }
+
+    statistics->num_enclave_workers = manager->num_enclave_workers;
+    statistics->num_active_enclave_workers =
+        manager->enclave_worker_pool.num_active_workers;
+    for (size_t i = 0; i < manager->num_enclave_workers; i++)
+    {
+        _get_enclave_worker_statistics(
+            manager,
+            &manager->enclave_worker_contexts[i],
+            now,
+            &worker_statistics);
+        _add_worker_statistics(
+            &statistics->enclave_workers, &worker_statistics);
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_get_switchless_worker_statistics(
+    oe_enclave_t* enclave,
+    oe_switchless_worker_type_t type,
+    size_t index,
+    oe_switchless_worker_statistics_t* statistics)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_switchless_call_manager_t* manager = NULL;
+
+    if (enclave == NULL || statistics == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if ((manager = enclave->switchless_manager) == NULL)
+        OE_RAISE_NO_TRACE(OE_NOT_FOUND);
+
+    switch (type)
+    {
+        case OE_SWITCHLESS_HOST_WORKER:
+        {
+            if (index >= manager->num_host_workers)
+                OE_RAISE(OE_OUT_OF_BOUNDS);
+
+            _get_host_worker_statistics(
+                &manager->host_worker_contexts[index], statistics);
+            break;
+        }
+        case OE_SWITCHLESS_ENCLAVE_WORKER:
+        {
+            if (index >= manager->num_enclave_workers)
+                OE_RAISE(OE_OUT_OF_BOUNDS);
+
+            _get_enclave_worker_statistics(
+                manager,
+                &manager->enclave_worker_contexts[index],
+                oe_switchless_get_time(),
+                statistics);
+            break;
+        }
+        default:
+            OE_RAISE(OE_INVALID_PARAMETER);
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_set_switchless_ecall_spin_budget(
+    oe_enclave_t* enclave,
+    uint64_t spin_budget_usec)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_switchless_call_manager_t* manager = NULL;
+    uint64_t spin_budget = OE_SWITCHLESS_SPIN_FOREVER;
+
+    if (enclave == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if ((manager = enclave->switchless_manager) == NULL)
+        OE_RAISE_NO_TRACE(OE_NOT_FOUND);
+
+    // Budgets too long to count in nanoseconds are as good as forever.
+    if (spin_budget_usec < OE_SWITCHLESS_SPIN_FOREVER / 1000)
+        spin_budget = spin_budget_usec * 1000;
+
+    // Callers already spinning keep the budget they started with.
+    manager->ecall_spin_budget = spin_budget;
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** _get_home_worker()
+**
+** Return the index of the calling host thread's home worker among count
+** workers. Hashing the thread id spreads the callers over the workers without
+** any shared state to update.
+**
+**==============================================================================
+*/
+static size_t _get_home_worker(size_t count)
+{
+    uint64_t id = (uint64_t)oe_thread_self();
+
+    // Fibonacci hashing.
+    return (size_t)(((id * 0x9E3779B97F4A7C15ULL) >> 32) % count);
+}
+
+/*
+**==============================================================================
+**
+** _wait_for_switchless_ecall()
+**
+** Wait until the enclave worker has handled the given call. Spin for the
+** spin budget, which keeps the latency of short calls low, then block so that
+** long calls do not keep a host core busy per caller.
+**
+**==============================================================================
+*/
+static void _wait_for_switchless_ecall(
+    oe_enclave_worker_context_t* context,
+    oe_call_enclave_function_args_t* args,
+    uint64_t start_time,
+    uint64_t spin_budget)
+{
+    for (uint64_t i = 1;; i++)
+    {
+        if (oe_atomic_load((uint64_t*)&context->call_arg) != (uint64_t)args)
+            return;
+
+        // Read the clock only once in a while.
+        if (spin_budget != OE_SWITCHLESS_SPIN_FOREVER && (i % 64) == 0 &&
+            oe_switchless_get_time() - start_time >= spin_budget)
+            break;
+
+        /* Yield CPU */
+        oe_yield_cpu();
+    }
+
+    // Register the call as waiting. The previous caller served by this
+    // worker may not have taken its own registration back yet.
+    context->caller_event = 0;
+    while (!oe_atomic_compare_and_swap_ptr(
+        (void* volatile*)&context->waiting_call, NULL, args))
+        oe_yield_cpu();
+
+    // The registration is a full barrier, so either the worker sees it after
+    // clearing the slot and wakes this thread up, or the check below sees the
+    // cleared slot.
+    while (oe_atomic_load((uint64_t*)&context->call_arg) == (uint64_t)args)
+    {
+        oe_switchless_caller_wait(context);
+
+        // The wakeup of an earlier caller of this worker may arrive late.
+        // Rearm the event before checking the call again.
+        oe_atomic_compare_and_swap_32((uint32_t*)&context->caller_event, 1, 0);
+    }
+
+    // Take the registration back if the worker did not.
+    oe_atomic_compare_and_swap_ptr(
+        (void* volatile*)&context->waiting_call, args, NULL);
+}
+
 /*
 **==============================================================================
 **
@@ -373,7 +1099,9 @@ static oe_result_t _switchless_call_enclave_function_impl(
     oe_call_enclave_function_args_t args;
     oe_switchless_call_manager_t* manager = enclave->switchless_manager;
     oe_enclave_worker_context_t* contexts = manager->enclave_worker_contexts;
-    size_t tries = 0;
+    oe_enclave_worker_context_t* first_context = NULL;
+    size_t num_active = manager->enclave_worker_pool.num_active_workers;
+    size_t home = 0;
 
     /* Reject invalid parameters */
     if (!enclave)
@@ -394,12 +1122,22 @@ static oe_result_t _switchless_call_enclave_function_impl(
     OE_ATOMIC_MEMORY_BARRIER_RELEASE();
     args.result = __OE_RESULT_MAX; // Means the call hasn't been processed.
 
-    // Cycle through the worker contexts until we find a free worker.
-    tries = manager->num_enclave_workers;
-    while (tries--)
+    // Cycle through the active worker contexts until we find a free worker.
+    // Start at the calling thread's home worker so that concurrent callers
+    // contend on different slots.
+    if (num_active > 0)
     {
+        home = _get_home_worker(num_active);
+        first_context = &contexts[home];
+    }
+
+    for (size_t i = 0; i < num_active; i++)
+    {
+        oe_enclave_worker_context_t* context =
+            &contexts[(home + i) % num_active];
+
         // Check if the worker's slot is free.
-        if (contexts[tries].call_arg == NULL)
+        if (context->call_arg == NULL)
         {
             // Try to atomically grab the slot by placing args in the slot.
             // If the atomic operation was successful, then the worker thread
@@ -408,7 +1146,7 @@ static oe_result_t _switchless_call_enclave_function_impl(
             // switchless ocall and therefore, we must scan for another worker
             // thread with a free slot.
             if (oe_atomic_compare_and_swap_ptr(
-                    (void* volatile*)&contexts[tries].call_arg, NULL, &args))
+                    (void* volatile*)&context->call_arg, NULL, &args))
             {
                 // The worker thread has been marked to execute this switchless
                 // call. Determine if it needs to be woken up or not.
@@ -429,25 +1167,31 @@ static oe_result_t _switchless_call_enclave_function_impl(
                 // Weak operation could sporadically fail.
                 // We need a strong operation.
                 if (oe_atomic_compare_and_swap_32(
-                        (uint32_t*)&contexts[tries].event, oldval, newval))
+                        (uint32_t*)&context->event, oldval, newval))
                 {
                     // The pevious value of the event was 0 which means that the
                     // worker was previously sleeping.
                     // Wake it.
-                    oe_enclave_worker_wake(&contexts[tries]);
+                    oe_atomic_increment(&context->wake_count);
+                    oe_enclave_worker_wake(context);
                 }
 
                 switchless_call_posted = true;
+                uint64_t start_time = oe_switchless_get_time();
+
                 // Wait for the  call to complete.
-                while (true)
-                {
-                    if (oe_atomic_load((uint64_t*)&contexts[tries].call_arg) !=
-                        (uint64_t)&args)
-                        break;
+                _wait_for_switchless_ecall(
+                    context,
+                    &args,
+                    start_time,
+                    oe_atomic_load(&manager->ecall_spin_budget));
 
-                    /* Yield CPU */
-                    oe_yield_cpu();
-                }
+                // Account the call for the elastic pool monitor. Other host
+                // threads may be posting to the same worker by now.
+                oe_atomic_increment(&context->call_count);
+                _atomic_add(
+                    &context->busy_time,
+                    oe_switchless_get_time() - start_time);
                 break;
             }
         }
@@ -455,6 +1199,9 @@ static oe_result_t _switchless_call_enclave_function_impl(
 
     if (!switchless_call_posted)
     {
+        if (first_context)
+            oe_atomic_increment(&first_context->missed_count);
+
         // Dispatch as normal ecall.
         OE_CHECK(oe_ecall(
             enclave, OE_ECALL_CALL_ENCLAVE_FUNCTION, (uint64_t)&args, NULL));
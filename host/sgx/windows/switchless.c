@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include <Windows.h>
+#include <openenclave/internal/raise.h>
 #include <openenclave/internal/switchless.h>
 
 static void _worker_wait(volatile long* event)
@@ -47,3 +48,85 @@ void oe_enclave_worker_wake(oe_enclave_worker_context_t* context)
 {
     _worker_wake(&context->event);
 }
+
+void oe_switchless_caller_wait(oe_enclave_worker_context_t* context)
+{
+    // Spurious wakes are handled by the caller checking the call again.
+    uint32_t zero = 0;
+    WaitOnAddress(&context->caller_event, &zero, sizeof(zero), INFINITE);
+}
+
+void oe_switchless_caller_wake(oe_enclave_worker_context_t* context)
+{
+    _worker_wake((volatile long*)&context->caller_event);
+}
+
+void oe_switchless_monitor_wait(
+    oe_switchless_call_manager_t* manager,
+    uint32_t timeout_msec)
+{
+    // The event is set only when the monitor is stopping.
+    uint32_t zero = 0;
+    WaitOnAddress(
+        &manager->monitor_event, &zero, sizeof(zero), (DWORD)timeout_msec);
+}
+
+void oe_switchless_monitor_wake(oe_switchless_call_manager_t* manager)
+{
+    _worker_wake((volatile long*)&manager->monitor_event);
+}
+
+uint64_t oe_switchless_get_time(void)
+{
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+
+    QueryPerformanceCounter(&counter);
+
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000ULL +
+           (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000ULL /
+               (uint64_t)frequency.QuadPart;
+}
+
+oe_result_t oe_switchless_set_thread_affinity(oe_thread_t thread, uint32_t cpu)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    GROUP_AFFINITY affinity = {0};
+
+    // CPUs are numbered across processor groups of 64 CPUs each.
+    affinity.Group = (WORD)(cpu / 64);
+    affinity.Mask = (KAFFINITY)1 << (cpu % 64);
+
+    if (!SetThreadGroupAffinity((HANDLE)thread, &affinity, NULL))
+        OE_RAISE_MSG(OE_FAILURE, "cannot pin worker to CPU %u", cpu);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void* oe_switchless_allocate_contexts(size_t size, int32_t numa_node)
+{
+    // The pages are zeroed. The node is only a preference: if it is full,
+    // the pages are taken from another node.
+    if (numa_node >= 0)
+        return VirtualAllocExNuma(
+            GetCurrentProcess(),
+            NULL,
+            size,
+            MEM_RESERVE | MEM_COMMIT,
+            PAGE_READWRITE,
+            (DWORD)numa_node);
+
+    return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+void oe_switchless_free_contexts(void* contexts, size_t size)
+{
+    OE_UNUSED(size);
+    VirtualFree(contexts, 0, MEM_RELEASE);
+}
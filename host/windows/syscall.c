@@ -1243,6 +1243,22 @@ done:
     return ret;
 }
 
+ssize_t oe_syscall_read_switchless_ocall(
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count)
+{
+    return oe_syscall_read_ocall(fd, buf, count);
+}
+
+ssize_t oe_syscall_write_switchless_ocall(
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count)
+{
+    return oe_syscall_write_ocall(fd, buf, count);
+}
+
 // oe_syscall_readv_ocall does not yet support socket.
 ssize_t oe_syscall_readv_ocall(
     oe_host_fd_t fd,
@@ -2343,6 +2359,15 @@ ssize_t oe_syscall_recv_ocall(
     return ret;
 }
 
+ssize_t oe_syscall_recv_switchless_ocall(
+    oe_host_fd_t sockfd,
+    void* buf,
+    size_t len,
+    int flags)
+{
+    return oe_syscall_recv_ocall(sockfd, buf, len, flags);
+}
+
 ssize_t oe_syscall_recvfrom_ocall(
     oe_host_fd_t sockfd,
     void* buf,
@@ -2393,6 +2418,15 @@ ssize_t oe_syscall_send_ocall(
     return ret;
 }
 
+ssize_t oe_syscall_send_switchless_ocall(
+    oe_host_fd_t sockfd,
+    const void* buf,
+    size_t len,
+    int flags)
+{
+    return oe_syscall_send_ocall(sockfd, buf, len, flags);
+}
+
 ssize_t oe_syscall_sendto_ocall(
     oe_host_fd_t sockfd,
     const void* buf,
@@ -2894,6 +2928,15 @@ int oe_syscall_epoll_wait_ocall(
     PANIC;
 }
 
+int oe_syscall_epoll_wait_switchless_ocall(
+    int64_t epfd,
+    struct oe_epoll_event* events,
+    unsigned int maxevents,
+    int timeout)
+{
+    return oe_syscall_epoll_wait_ocall(epfd, events, maxevents, timeout);
+}
+
 int oe_syscall_epoll_wake_ocall(void)
 {
     PANIC;
@@ -54,7 +54,8 @@ void oe_allocator_cleanup(void);
  * initialized.
  *
  * Note: Each ecall starts a new enclave thread that terminates when the ecall
- * returns.
+ * returns, unless the enclave keeps its thread-local storage across ecalls
+ * (see OE_SET_ENCLAVE_SGX_PERSISTENT_THREAD_LOCALS).
  */
 void oe_allocator_thread_init(void);
 
@@ -66,10 +67,29 @@ void oe_allocator_thread_init(void);
  * functions) will be executed prior to oe_allocator_thread_cleanup.
  *
  * Note: Each ecall starts a new enclave thread that terminates when the ecall
- * returns.
+ * returns, unless the enclave keeps its thread-local storage across ecalls
+ * (see OE_SET_ENCLAVE_SGX_PERSISTENT_THREAD_LOCALS).
  */
 void oe_allocator_thread_cleanup(void);
 
+/**
+ * Callback for cleaning up the thread-specific state of another thread.
+ *
+ * This function will be called by oecore when an enclave that keeps its
+ * thread-local storage across ecalls (see
+ * OE_SET_ENCLAVE_SGX_PERSISTENT_THREAD_LOCALS) is terminated, once for each
+ * enclave thread other than the calling one, before the thread-local
+ * variables of that thread are cleared. That thread is not running.
+ *
+ * Allocators that do not implement this callback leave the thread-specific
+ * state of such threads as is.
+ *
+ * @param tls_offset The offset, in bytes, from the address of a thread-local
+ * variable of the calling thread to the address of the same variable of the
+ * thread to clean up.
+ */
+void oe_allocator_thread_release(ptrdiff_t tls_offset);
+
 /**
  * Callback to allocate memory.
  *
@@ -48,6 +48,65 @@ typedef struct _oe_mallinfo
  */
 oe_result_t oe_allocator_mallinfo(oe_mallinfo_t* info);
 
+/// Number of request size classes in the allocator statistics
+#define OE_ALLOCATOR_STATS_SIZE_CLASSES 24
+
+/// Maximum number of enclave threads in the allocator statistics
+#define OE_ALLOCATOR_STATS_MAX_THREADS 32
+
+typedef struct _oe_allocator_thread_stats
+{
+    /// Number of blocks allocated by the thread.
+    uint64_t allocations;
+    /// Number of blocks freed by the thread.
+    uint64_t frees;
+    /// Number of usable bytes in the blocks allocated by the thread.
+    uint64_t allocated_bytes;
+    /// Number of usable bytes in the blocks freed by the thread.
+    uint64_t freed_bytes;
+    /// Number of blocks allocated by the thread by requested size. Class 0
+    /// counts requests of up to 16 bytes, class i requests of more than
+    /// 2^(i+3) and up to 2^(i+4) bytes, and the last class all larger ones.
+    uint64_t size_classes[OE_ALLOCATOR_STATS_SIZE_CLASSES];
+} oe_allocator_thread_stats_t;
+
+typedef struct _oe_allocator_stats
+{
+    /// Maximum number of bytes that can be allocated in total.
+    size_t max_total_heap_size;
+    /// Number of bytes allocated at the moment.
+    size_t current_allocated_heap_size;
+    /// Highest value reached by `current_allocated_heap_size` during execution.
+    size_t peak_allocated_heap_size;
+    /// Highest number of bytes of the heap the allocator used at once,
+    /// including its own overhead and free blocks.
+    size_t heap_high_water_mark;
+    /// Number of blocks allocated by requested size, by all threads.
+    uint64_t size_classes[OE_ALLOCATOR_STATS_SIZE_CLASSES];
+    /// Number of entries in `threads`.
+    uint64_t num_threads;
+    /// Statistics of each enclave thread, in the order the threads first
+    /// used the allocator. A thread is a TCS on SGX.
+    oe_allocator_thread_stats_t threads[OE_ALLOCATOR_STATS_MAX_THREADS];
+} oe_allocator_stats_t;
+
+/**
+ * Obtain detailed memory usage statistics.
+ *
+ * This extends oe_allocator_mallinfo() with the high-water mark of the heap
+ * and with allocation counters by size and by thread, to help size the heap
+ * of an enclave. The host can obtain them with oe_get_allocator_stats().
+ * Statistics the allocator does not track are set to zero.
+ *
+ * @param[out] stats An oe_allocator_stats_t struct, to be populated by the
+ * allocator.
+ *
+ * @retval OE_OK Statistics were set successfully.
+ * @retval OE_UNSUPPORTED The allocator does not support this interface.
+ * @retval OE_FAILURE Other failure.
+ */
+oe_result_t oe_allocator_get_stats(oe_allocator_stats_t* stats);
+
 OE_EXTERNC_END
 
 #endif // OE_ADVANCED_MALLINFO_H
@@ -74,6 +74,23 @@ oe_result_t oe_load_module_host_resolver(void);
  * @retval OE_FAILURE Module failed to load.
  */
 oe_result_t oe_load_module_host_epoll(void);
+
+/**
+ * Perform host I/O with switchless ocalls.
+ *
+ * When enabled, host I/O calls that cannot block are performed as switchless
+ * ocalls whenever the host has started switchless workers for the enclave
+ * (see OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS). These are read and write on
+ * regular host files or non-blocking descriptors, send and recv on
+ * non-blocking host sockets or with MSG_DONTWAIT, and epoll_wait with a zero
+ * timeout. All other calls are performed as regular ocalls, so that a
+ * blocking call never holds a host worker.
+ *
+ * @param enabled Whether to use switchless ocalls for host I/O.
+ *
+ * @retval OE_OK The setting was applied.
+ */
+oe_result_t oe_set_switchless_syscalls(bool enabled);
 OE_EXTERNC_END
 
 #endif /* _OE_BITS_MODULE_H */
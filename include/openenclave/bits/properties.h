@@ -61,6 +61,7 @@ typedef struct _oe_enclave_properties_header
     HEAP_PAGE_COUNT,        \
     STACK_PAGE_COUNT,       \
     TCS_COUNT)
+#define OE_SET_ENCLAVE_SGX_PERSISTENT_THREAD_LOCALS()
 #endif
 
 #if __aarch64__
@@ -229,4 +229,20 @@ typedef struct _oe_sgx_enclave_properties
 
 // clang-format on
 
+/**
+ * Keeps the thread-local storage of the enclave across ECALLs.
+ *
+ * By default, the thread-local variables and the pthread_key values of an
+ * enclave thread are initialized when an outermost ECALL enters the enclave
+ * and destroyed when it returns. In an enclave defined with this macro, they
+ * stay bound to the TCS across ECALLs. They are destroyed and reinitialized
+ * only:
+ * - when the outermost ECALL returns after a call to oe_reset_thread_locals()
+ * - when the TCS is used by another host thread than the previous ECALL
+ * - when the enclave is terminated, for every TCS. The destructors of the
+ *   other TCSs then run on the thread that terminates the enclave.
+ */
+#define OE_SET_ENCLAVE_SGX_PERSISTENT_THREAD_LOCALS() \
+    OE_EXTERNC const bool oe_sgx_persistent_thread_locals = true
+
 #endif /* _OE_BITS_SGX_SGXPROPERTIES_H */
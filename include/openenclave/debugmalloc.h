@@ -53,6 +53,26 @@ oe_result_t oe_debug_malloc_tracking_report(
     uint64_t* out_object_count,
     char** report);
 
+/**
+ * Function to set the sampling interval of debug malloc.
+ *
+ * By default, debug malloc records the callstack of every allocation, which
+ * is too slow for some workloads. With a non-zero interval, it only records
+ * the callstacks of a random sample of the allocations, such that one
+ * allocation is sampled for every **interval** bytes allocated on average.
+ * All blocks are still checked for overwrites, but only the sampled blocks
+ * are reported as leaks, by oe_debug_malloc_tracking_report() and on enclave
+ * termination. Setting oe_use_debug_malloc_memset to false further reduces
+ * the overhead of debug malloc.
+ *
+ * @param[in] interval The mean number of bytes allocated between two sampled
+ * allocations, or 0 to sample every allocation.
+ *
+ * @retval OE_OK The interval was set.
+ * @retval OE_INVALID_PARAMETER **interval** is larger than OE_INT32_MAX.
+ */
+oe_result_t oe_debug_malloc_set_sampling_interval(uint64_t interval);
+
 OE_EXTERNC_END
 
 #endif /* _OE_DEBUG_MALLOC_H */
@@ -78,6 +78,60 @@ oe_result_t oe_call_host_function(
     size_t output_buffer_size,
     size_t* output_bytes_written);
 
+/**
+ * Description of one host function call in a batch submitted via
+ * oe_call_host_functions().
+ */
+typedef struct _oe_host_function_call
+{
+    /** The id of the host function that will be called. */
+    size_t function_id;
+
+    /** Buffer containing inputs data. */
+    const void* input_buffer;
+
+    /** Size of the input data buffer. */
+    size_t input_buffer_size;
+
+    /** Buffer where the outputs of the host function are written to. */
+    void* output_buffer;
+
+    /** Size of the output buffer. */
+    size_t output_buffer_size;
+
+    /** [out] Number of bytes written in the output buffer. */
+    size_t output_bytes_written;
+
+    /** [out] The status of this call, as for oe_call_host_function(). */
+    oe_result_t result;
+} oe_host_function_call_t;
+
+/**
+ * Perform several high-level host function calls (OCALLs) with a single
+ * enclave exit.
+ *
+ * The host dispatches the calls in the given order and returns the results of
+ * all of them together. A failing call does not prevent the subsequent calls
+ * from being dispatched; the status of each call is stored in its **result**
+ * field.
+ *
+ * The input and output buffers of the calls must reside in host memory and
+ * must be distinct for each call. In particular, they must not be obtained
+ * from oe_allocate_ocall_buffer(), which returns the same per-thread buffer
+ * for every call.
+ *
+ * @param calls The calls to perform.
+ * @param num_calls The number of calls.
+ *
+ * @return OE_OK the batch was dispatched; see the result of each call.
+ * @return OE_INVALID_PARAMETER a parameter is invalid, or a buffer does not
+ * reside in host memory.
+ * @return OE_OUT_OF_MEMORY the batch descriptor could not be allocated.
+ */
+oe_result_t oe_call_host_functions(
+    oe_host_function_call_t* calls,
+    size_t num_calls);
+
 /**
  * Perform a high-level host function call (OCALL) switchlessly.
  *
@@ -117,6 +171,112 @@ oe_result_t oe_switchless_call_host_function(
     size_t output_buffer_size,
     size_t* output_bytes_written);
 
+/**
+ * Completion handle of an asynchronous switchless host function call.
+ *
+ * The handle is filled in by oe_switchless_call_host_function_async() and
+ * consumed by oe_switchless_call_poll(), oe_switchless_call_wait() or
+ * oe_switchless_call_wait_any(). Its fields are internal.
+ */
+typedef struct _oe_switchless_call_handle
+{
+    /* The call descriptor shared with the host worker. NULL once consumed. */
+    void* args;
+
+    /* The size of the output buffer, kept out of the reach of the host. */
+    size_t output_buffer_size;
+} oe_switchless_call_handle_t;
+
+/**
+ * Post a host function call (OCALL) to a switchless worker and return without
+ * waiting for it to complete.
+ *
+ * The input and output buffers must have been allocated with
+ * oe_allocate_switchless_ocall_buffer() and must not be accessed until the
+ * call has completed. They stay valid across subsequent switchless calls made
+ * by the same thread. All asynchronous calls posted by a thread must be
+ * completed via oe_switchless_call_poll(), oe_switchless_call_wait() or
+ * oe_switchless_call_wait_any() before the ECALL that posted them returns.
+ *
+ * If switchless calls are not initialized, or no host worker can take the
+ * call, the call is performed synchronously as a regular OCALL and the
+ * returned handle is already complete.
+ *
+ * @param function_id The id of the host function that will be called.
+ * @param input_buffer Buffer containing inputs data.
+ * @param input_buffer_size Size of the input data buffer.
+ * @param output_buffer Buffer where the outputs of the host function are
+ * written to.
+ * @param output_buffer_size Size of the output buffer.
+ * @param handle The completion handle of the call.
+ *
+ * @return OE_OK the call was posted (or performed synchronously).
+ * @return OE_INVALID_PARAMETER a parameter is invalid.
+ * @return OE_OUT_OF_MEMORY the call descriptor could not be allocated.
+ */
+oe_result_t oe_switchless_call_host_function_async(
+    size_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size,
+    oe_switchless_call_handle_t* handle);
+
+/**
+ * Check whether an asynchronous switchless host function call has completed.
+ *
+ * Once this function returns a value other than OE_BUSY, the handle is
+ * consumed and must not be used again.
+ *
+ * @param handle The completion handle of the call.
+ * @param output_bytes_written Number of bytes written in the output buffer.
+ *
+ * @return OE_BUSY the call is still in progress.
+ * @return OE_INVALID_PARAMETER the handle is invalid or already consumed.
+ * @return Otherwise, the status of the call as for
+ * oe_switchless_call_host_function().
+ */
+oe_result_t oe_switchless_call_poll(
+    oe_switchless_call_handle_t* handle,
+    size_t* output_bytes_written);
+
+/**
+ * Wait for an asynchronous switchless host function call to complete.
+ *
+ * @param handle The completion handle of the call.
+ * @param output_bytes_written Number of bytes written in the output buffer.
+ *
+ * @return OE_INVALID_PARAMETER the handle is invalid or already consumed.
+ * @return Otherwise, the status of the call as for
+ * oe_switchless_call_host_function().
+ */
+oe_result_t oe_switchless_call_wait(
+    oe_switchless_call_handle_t* handle,
+    size_t* output_bytes_written);
+
+/**
+ * Wait for any of the given asynchronous switchless host function calls to
+ * complete.
+ *
+ * Handles that have already been consumed are skipped. Only the handle of the
+ * completed call is consumed.
+ *
+ * @param handles The completion handles of the calls.
+ * @param count The number of handles.
+ * @param index The index of the completed call in **handles**.
+ * @param output_bytes_written Number of bytes written in the output buffer of
+ * the completed call.
+ *
+ * @return OE_INVALID_PARAMETER no valid handle was given.
+ * @return Otherwise, the status of the completed call as for
+ * oe_switchless_call_host_function().
+ */
+oe_result_t oe_switchless_call_wait_any(
+    oe_switchless_call_handle_t* handles,
+    size_t count,
+    size_t* index,
+    size_t* output_bytes_written);
+
 /**
  * Allocate a buffer of given size for doing an ocall.
  *
@@ -76,6 +76,60 @@ oe_result_t oe_call_enclave_function(
     size_t output_buffer_size,
     size_t* output_bytes_written);
 
+/**
+ * Description of one enclave function call in a batch submitted via
+ * oe_call_enclave_functions().
+ */
+typedef struct _oe_enclave_function_call
+{
+    /** The global id of the enclave function that will be called. */
+    uint64_t* global_id;
+
+    /** The name of the function that will be called. */
+    const char* name;
+
+    /** Buffer containing inputs data. */
+    const void* input_buffer;
+
+    /** Size of the input data buffer. */
+    size_t input_buffer_size;
+
+    /** Buffer where the outputs of the enclave function are written to. */
+    void* output_buffer;
+
+    /** Size of the output buffer. */
+    size_t output_buffer_size;
+
+    /** [out] Number of bytes written in the output buffer. */
+    size_t output_bytes_written;
+
+    /** [out] The status of this call, as for oe_call_enclave_function(). */
+    oe_result_t result;
+} oe_enclave_function_call_t;
+
+/**
+ * Perform several high-level enclave function calls (ECALLs) with a single
+ * enclave entry.
+ *
+ * The enclave dispatches the calls in the given order on the same thread and
+ * returns the results of all of them together. A failing call does not
+ * prevent the subsequent calls from being dispatched; the status of each call
+ * is stored in its **result** field.
+ *
+ * @param enclave The enclave to call into.
+ * @param calls The calls to perform.
+ * @param num_calls The number of calls.
+ *
+ * @return OE_OK the batch was dispatched; see the result of each call.
+ * @return OE_NOT_FOUND the name of a call does not match an enclave function.
+ * @return OE_INVALID_PARAMETER a parameter is invalid.
+ * @return OE_OUT_OF_MEMORY the batch descriptor could not be allocated.
+ */
+oe_result_t oe_call_enclave_functions(
+    oe_enclave_t* enclave,
+    oe_enclave_function_call_t* calls,
+    size_t num_calls);
+
 /**
  * Placeholder.
  */
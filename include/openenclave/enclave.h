@@ -201,6 +201,132 @@ void oe_host_free(void* ptr);
  */
 char* oe_host_strndup(const char* str, size_t n);
 
+/**
+ * Copy bytes from a region of host memory shared with the enclave.
+ *
+ * The region is registered by the host with oe_register_shared_memory(),
+ * which checks once that it lies outside the enclave. Large payloads can be
+ * consumed piecewise by advancing **offset**, each byte being copied once
+ * from the host.
+ *
+ * @param[in] region_id The identifier of the region.
+ * @param[in] offset The offset in the region of the first byte to copy.
+ * @param[out] buffer The buffer the bytes are copied to.
+ * @param[in] size The number of bytes to copy.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER a parameter is invalid.
+ * @returns OE_NOT_FOUND the region is not registered.
+ * @returns OE_OUT_OF_BOUNDS the bytes are not all in the region.
+ *
+ */
+oe_result_t oe_shared_memory_read(
+    uint64_t region_id,
+    size_t offset,
+    void* buffer,
+    size_t size);
+
+/**
+ * Copy bytes to a region of host memory shared with the enclave.
+ *
+ * The bytes become visible to the host: they must not be secrets.
+ *
+ * @param[in] region_id The identifier of the region.
+ * @param[in] offset The offset in the region the bytes are copied to.
+ * @param[in] buffer The bytes to copy.
+ * @param[in] size The number of bytes to copy.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER a parameter is invalid.
+ * @returns OE_NOT_FOUND the region is not registered.
+ * @returns OE_OUT_OF_BOUNDS the bytes do not all fit in the region.
+ *
+ */
+oe_result_t oe_shared_memory_write(
+    uint64_t region_id,
+    size_t offset,
+    const void* buffer,
+    size_t size);
+
+/**
+ * Get the address and size of a region of host memory shared with the
+ * enclave, to process its contents in place.
+ *
+ * The host can change the contents of the region at any time: each value
+ * the enclave relies on must be read from the region only once.
+ *
+ * @param[in] region_id The identifier of the region.
+ * @param[out] address The address of the region.
+ * @param[out] size The size in bytes of the region.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER a parameter is invalid.
+ * @returns OE_NOT_FOUND the region is not registered.
+ *
+ */
+oe_result_t oe_shared_memory_get(
+    uint64_t region_id,
+    void** address,
+    size_t* size);
+
+/**
+ * Growth counters of the shared memory arenas that hold the parameters of
+ * switchless OCALLs, summed over all the enclave threads.
+ */
+typedef struct _oe_switchless_arena_statistics
+{
+    /** The number of host chunks added to the arenas after their first one. */
+    uint64_t grow_count;
+    /** The total capacity in bytes of these chunks. */
+    uint64_t grow_bytes;
+    /** The number of host chunks given back to the host. */
+    uint64_t trim_count;
+} oe_switchless_arena_statistics_t;
+
+/**
+ * Set the capacity the switchless shared memory arenas keep between calls.
+ *
+ * An arena grows with host chunks when the parameters of a switchless OCALL
+ * do not fit in it. When the call returns, the chunks that take the capacity
+ * of the arena above the watermark are given back to the host. The default
+ * watermark is 16 MB.
+ *
+ * @param[in] watermark The capacity in bytes kept by each arena.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_UNSUPPORTED the enclave type does not support this function.
+ *
+ */
+oe_result_t oe_set_switchless_arena_watermark(size_t watermark);
+
+/**
+ * Get the growth counters of the switchless shared memory arenas.
+ *
+ * @param[out] statistics The counters of the arenas of all the threads.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER **statistics** is null.
+ * @returns OE_UNSUPPORTED the enclave type does not support this function.
+ *
+ */
+oe_result_t oe_get_switchless_arena_statistics(
+    oe_switchless_arena_statistics_t* statistics);
+
+/**
+ * Reinitialize the thread-local storage of the calling thread.
+ *
+ * In an enclave that keeps its thread-local storage across ECALLs (see
+ * OE_SET_ENCLAVE_SGX_PERSISTENT_THREAD_LOCALS), the thread-local variables
+ * and the pthread_key values of the calling thread are destroyed when the
+ * current outermost ECALL returns, and initialized again by the next ECALL.
+ * Other enclaves already do this on every ECALL.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_UNSUPPORTED the enclave type does not support this function.
+ *
+ */
+oe_result_t oe_reset_thread_locals(void);
+
 /**
  * Abort execution of the enclave.
  *
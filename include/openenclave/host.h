@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "advanced/mallinfo.h"
 #include "bits/defs.h"
 #include "bits/eeid.h"
 #include "bits/evidence.h"
@@ -98,6 +99,9 @@ typedef void (*oe_ocall_func_t)(
 typedef enum _oe_enclave_setting_type
 {
     OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS = 0xdc73a628,
+    OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS_ELASTIC = 0x5e1a57c3,
+    OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS_PLACEMENT = 0x8b2d41e6,
+    OE_ENCLAVE_SETTING_OCALL_BUFFER = 0x3c9e07b5,
 #ifdef OE_WITH_EXPERIMENTAL_EEID
     OE_EXTENDED_ENCLAVE_INITIALIZATION_DATA = 0x976a8f66,
 #endif
@@ -121,6 +125,121 @@ typedef struct _oe_enclave_setting_context_switchless
     size_t max_enclave_workers;
 } oe_enclave_setting_context_switchless_t;
 
+/**
+ * The setting for context-switchless calls served by elastic worker pools.
+ *
+ * The max number of workers of each pool are created up front, but only the
+ * active ones are handed calls; the others sleep. The number of active
+ * workers is periodically adjusted between the min and the max: a worker is
+ * added when calls miss (fall back to a regular call) or when the active
+ * workers are busier than the target utilization, and one is retired when
+ * the remaining workers would still stay below the target.
+ */
+typedef struct _oe_enclave_setting_context_switchless_elastic
+{
+    /**
+     * The min number of worker threads for context-switchless ocalls. At
+     * least one worker is kept active if max_host_workers is not 0.
+     */
+    size_t min_host_workers;
+    /**
+     * The max number of worker threads for context-switchless ocalls.
+     * The actual number of threads launched could be capped for performance
+     * reasons.
+     */
+    size_t max_host_workers;
+    /**
+     * The min number of worker threads for context-switchless ecalls. At
+     * least one worker is kept active if max_enclave_workers is not 0.
+     */
+    size_t min_enclave_workers;
+    /**
+     * The max number of worker threads for context-switchless ecalls. Each of
+     * them occupies a TCS of the enclave, whether active or not.
+     */
+    size_t max_enclave_workers;
+    /**
+     * The targeted percentage of time the active workers spend handling
+     * calls, between 1 and 100.
+     */
+    uint32_t target_utilization;
+    /**
+     * The interval in milliseconds between two adjustments of the number of
+     * active workers. If 0, a default interval of 10 milliseconds is used.
+     */
+    uint32_t adjust_interval_msec;
+} oe_enclave_setting_context_switchless_elastic_t;
+
+/**
+ * The value of a NUMA node setting that leaves the choice of the node to the
+ * operating system.
+ */
+#define OE_SWITCHLESS_NUMA_NODE_ANY (-1)
+
+/**
+ * The setting for the placement of context-switchless worker threads and of
+ * the contexts they share with the callers. It complements
+ * OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS or
+ * OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS_ELASTIC and is ignored without them.
+ *
+ * Pinning the workers and the threads that make switchless calls to CPUs of
+ * the same NUMA node, and allocating the contexts on that node, keeps the
+ * cache lines they exchange local to the node.
+ */
+typedef struct _oe_enclave_setting_context_switchless_placement
+{
+    /**
+     * The CPUs the host worker threads are pinned to. Host worker i runs on
+     * host_worker_cpus[i % host_worker_cpu_count]. If NULL, the host workers
+     * are not pinned.
+     */
+    const uint32_t* host_worker_cpus;
+    /** The number of entries of host_worker_cpus. */
+    size_t host_worker_cpu_count;
+    /**
+     * The CPUs the enclave worker threads are pinned to. Enclave worker i
+     * runs on enclave_worker_cpus[i % enclave_worker_cpu_count]. If NULL, the
+     * enclave workers are not pinned.
+     */
+    const uint32_t* enclave_worker_cpus;
+    /** The number of entries of enclave_worker_cpus. */
+    size_t enclave_worker_cpu_count;
+    /**
+     * The NUMA node the host worker contexts are allocated on, or
+     * OE_SWITCHLESS_NUMA_NODE_ANY.
+     */
+    int32_t host_worker_numa_node;
+    /**
+     * The NUMA node the enclave worker contexts are allocated on, or
+     * OE_SWITCHLESS_NUMA_NODE_ANY.
+     */
+    int32_t enclave_worker_numa_node;
+} oe_enclave_setting_context_switchless_placement_t;
+
+/**
+ * The setting for the per-thread host buffers the enclave marshals OCALLs in.
+ *
+ * Each enclave thread context is given a host buffer for the arguments of
+ * its OCALLs. An OCALL whose arguments do not fit in the buffer costs two
+ * extra OCALLs, to allocate and to free host memory. When a thread keeps
+ * making such OCALLs, its buffer is grown at its next outermost ECALL, up to
+ * max_size.
+ */
+typedef struct _oe_enclave_setting_ocall_buffer
+{
+    /**
+     * The initial size in bytes of the buffer of each thread. If 0, the
+     * default size of 16 KB is used.
+     */
+    size_t initial_size;
+    /**
+     * The size in bytes the buffer of each thread may grow to. If 0, the
+     * default of 1 MB is used. The buffers never grow if max_size is not
+     * larger than initial_size.
+     */
+    size_t max_size;
+} oe_enclave_setting_ocall_buffer_t;
+
 /**
  * The uniform structure type containing a specific type of enclave
  * setting.
@@ -138,6 +257,11 @@ typedef struct _oe_enclave_setting
     union {
         const oe_enclave_setting_context_switchless_t*
             context_switchless_setting;
+        const oe_enclave_setting_context_switchless_elastic_t*
+            context_switchless_elastic_setting;
+        const oe_enclave_setting_context_switchless_placement_t*
+            context_switchless_placement_setting;
+        const oe_enclave_setting_ocall_buffer_t* ocall_buffer_setting;
 #ifdef OE_WITH_EXPERIMENTAL_EEID
         oe_eeid_t* eeid;
 #endif
@@ -145,6 +269,77 @@ typedef struct _oe_enclave_setting
     } u;
 } oe_enclave_setting_t;
 
+/**
+ * The kinds of context-switchless worker threads.
+ */
+typedef enum _oe_switchless_worker_type
+{
+    /** Host worker threads, which handle context-switchless ocalls. */
+    OE_SWITCHLESS_HOST_WORKER,
+    /** Enclave worker threads, which handle context-switchless ecalls. */
+    OE_SWITCHLESS_ENCLAVE_WORKER,
+    __OE_SWITCHLESS_WORKER_TYPE_MAX = OE_ENUM_MAX,
+} oe_switchless_worker_type_t;
+
+/**
+ * Counters of a context-switchless worker thread, or of all the worker
+ * threads of a kind. Times are in nanoseconds.
+ */
+typedef struct _oe_switchless_worker_statistics
+{
+    /** The number of calls handled by the worker. */
+    uint64_t call_count;
+    /**
+     * The number of calls that missed, i.e. that fell back to a regular
+     * ocall/ecall because no worker could take them. A miss is counted on the
+     * first worker the call was offered to.
+     */
+    uint64_t missed_count;
+    /**
+     * The number of times the worker was woken up. For host workers, this is
+     * the number of wakeup ocalls issued by the enclave.
+     */
+    uint64_t wake_count;
+    /** The time spent handling calls. */
+    uint64_t busy_time;
+    /**
+     * The time spent spinning while waiting for calls. For enclave workers,
+     * which spin inside the enclave, this is the time not accounted as busy
+     * or sleeping.
+     */
+    uint64_t spin_time;
+    /** The time spent sleeping while waiting for calls. */
+    uint64_t sleep_time;
+    /**
+     * The total time calls spent queued behind other calls before the worker
+     * started handling them. Enclave workers take one call at a time, so this
+     * is always 0 for them.
+     */
+    uint64_t queue_time;
+} oe_switchless_worker_statistics_t;
+
+/**
+ * Counters of the context-switchless calls of an enclave.
+ */
+typedef struct _oe_switchless_statistics
+{
+    /** The number of host worker threads. */
+    size_t num_host_workers;
+    /**
+     * The number of host worker threads that are currently active. These are
+     * the first ones; the others are parked by their elastic pool.
+     */
+    size_t num_active_host_workers;
+    /** The sum of the counters of the host worker threads. */
+    oe_switchless_worker_statistics_t host_workers;
+    /** The number of enclave worker threads. */
+    size_t num_enclave_workers;
+    /** The number of enclave worker threads that are currently active. */
+    size_t num_active_enclave_workers;
+    /** The sum of the counters of the enclave worker threads. */
+    oe_switchless_worker_statistics_t enclave_workers;
+} oe_switchless_statistics_t;
+
 /**
  * Structure describing an ecall.
  */
@@ -217,6 +412,288 @@ oe_result_t oe_create_enclave(
  */
 oe_result_t oe_terminate_enclave(oe_enclave_t* enclave);
 
+/**
+ * Get the counters of the context-switchless calls of an enclave.
+ *
+ * The counters are read while the workers are running, so they are not an
+ * atomic snapshot of all the workers.
+ *
+ * @param[in] enclave The enclave, created with context-switchless calls
+ * enabled.
+ *
+ * @param[out] statistics The counters of the enclave.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER a parameter is invalid.
+ * @returns OE_NOT_FOUND context-switchless calls are not enabled.
+ *
+ */
+oe_result_t oe_get_switchless_statistics(
+    oe_enclave_t* enclave,
+    oe_switchless_statistics_t* statistics);
+
+/**
+ * Get the counters of one context-switchless worker thread of an enclave.
+ *
+ * @param[in] enclave The enclave, created with context-switchless calls
+ * enabled.
+ *
+ * @param[in] type The kind of the worker thread.
+ *
+ * @param[in] index The index of the worker thread among the workers of its
+ * kind, lower than the number of workers returned by
+ * **oe_get_switchless_statistics()**.
+ *
+ * @param[out] statistics The counters of the worker thread.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER a parameter is invalid.
+ * @returns OE_NOT_FOUND context-switchless calls are not enabled.
+ * @returns OE_OUT_OF_BOUNDS there is no worker thread at this index.
+ *
+ */
+oe_result_t oe_get_switchless_worker_statistics(
+    oe_enclave_t* enclave,
+    oe_switchless_worker_type_t type,
+    size_t index,
+    oe_switchless_worker_statistics_t* statistics);
+
+/**
+ * The spin budget that makes host threads spin on their context-switchless
+ * ecalls until the calls complete.
+ */
+#define OE_SWITCHLESS_SPIN_FOREVER OE_UINT64_MAX
+
+/**
+ * Set how long host threads spin on a context-switchless ecall of an enclave
+ * before blocking until the ecall completes.
+ *
+ * Spinning keeps the latency of short ecalls low, while blocking stops long
+ * ecalls from keeping a host core busy per caller. An enclave worker wakes
+ * the blocked caller up with an ocall once the ecall completes.
+ *
+ * @param[in] enclave The enclave, created with context-switchless calls
+ * enabled.
+ *
+ * @param[in] spin_budget_usec The time in microseconds to spin before
+ * blocking: 0 to block right away, or OE_SWITCHLESS_SPIN_FOREVER to never
+ * block. The default is 50 microseconds.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER a parameter is invalid.
+ * @returns OE_NOT_FOUND context-switchless calls are not enabled.
+ *
+ */
+oe_result_t oe_set_switchless_ecall_spin_budget(
+    oe_enclave_t* enclave,
+    uint64_t spin_budget_usec);
+
+/**
+ * Register a region of host memory with an enclave.
+ *
+ * Once registered, the enclave reads and writes the region directly with
+ * oe_shared_memory_read() and oe_shared_memory_write(), or processes it in
+ * place through oe_shared_memory_get(), instead of having its contents
+ * marshaled by each ECALL or OCALL. The enclave checks once that the region
+ * lies outside the enclave.
+ *
+ * The region must stay allocated until it is unregistered or the enclave is
+ * terminated. The host can read and change the region at any time, so the
+ * enclave must not store secrets in it nor trust its contents.
+ *
+ * The enclave must import sgx/sharedmemory.edl (or sgx/platform.edl).
+ *
+ * @param[in] enclave The enclave the region is shared with.
+ * @param[in] address The address of the region.
+ * @param[in] size The size in bytes of the region.
+ * @param[out] region_id The identifier of the region, to be passed to the
+ * enclave with the ECALLs that access the region.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER a parameter is invalid or the region is not
+ * outside the enclave.
+ * @returns OE_OUT_OF_MEMORY the enclave has no room for another region.
+ * @returns OE_UNSUPPORTED the enclave does not import the EDL.
+ *
+ */
+oe_result_t oe_register_shared_memory(
+    oe_enclave_t* enclave,
+    void* address,
+    size_t size,
+    uint64_t* region_id);
+
+/**
+ * Unregister a region of host memory registered with
+ * oe_register_shared_memory().
+ *
+ * The enclave must not be accessing the region when it is unregistered.
+ *
+ * @param[in] enclave The enclave the region is shared with.
+ * @param[in] region_id The identifier of the region.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER a parameter is invalid.
+ * @returns OE_NOT_FOUND the region is not registered.
+ * @returns OE_UNSUPPORTED the enclave does not import the EDL.
+ *
+ */
+oe_result_t oe_unregister_shared_memory(
+    oe_enclave_t* enclave,
+    uint64_t region_id);
+
+/**
+ * Number of buckets of a call latency histogram.
+ */
+#define OE_CALL_LATENCY_BUCKETS 32
+
+/**
+ * The direction of the calls a latency histogram is about.
+ */
+typedef enum _oe_call_direction
+{
+    /** Calls from the host into the enclave */
+    OE_CALL_DIRECTION_ECALL,
+    /** Calls from the enclave out to the host */
+    OE_CALL_DIRECTION_OCALL,
+    /** Unused */
+    __OE_CALL_DIRECTION_MAX = OE_ENUM_MAX,
+} oe_call_direction_t;
+
+/**
+ * Latency histogram of the calls to one ECALL or OCALL function.
+ */
+typedef struct _oe_call_latency_histogram
+{
+    /** The function id of the ECALL or OCALL in the EDL of the enclave */
+    uint64_t function_id;
+
+    /** The number of calls */
+    uint64_t count;
+
+    /** The sum of the latencies of the calls in nanoseconds */
+    uint64_t total_nsec;
+
+    /**
+     * The number of calls per latency. Bucket i counts the calls that took
+     * from 2^i up to 2^(i+1) - 1 nanoseconds. Bucket 0 also counts the calls
+     * that took less than 1 nanosecond and the last bucket counts all the
+     * calls that took longer.
+     */
+    uint64_t buckets[OE_CALL_LATENCY_BUCKETS];
+} oe_call_latency_histogram_t;
+
+/**
+ * Enable or disable the latency histograms of the calls to an enclave.
+ *
+ * When enabled, the latency of every ECALL made with
+ * oe_call_enclave_function() is measured on the host from the time the
+ * enclave is entered to the time it returns, nested calls included. The
+ * latency of every OCALL is measured from the time the host function is
+ * called to the time it returns. Switchless calls are not measured.
+ *
+ * Each enclave thread keeps its own histograms, which are only updated by
+ * the host thread bound to it, so measuring a call takes no lock.
+ *
+ * Disabling the histograms stops the measurements but keeps the values
+ * measured so far.
+ *
+ * @param[in] enclave The enclave.
+ * @param[in] enable Whether to measure the calls.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER a parameter is invalid.
+ * @returns OE_OUT_OF_MEMORY the histograms cannot be allocated.
+ * @returns OE_UNSUPPORTED the enclave type does not support the histograms.
+ *
+ */
+oe_result_t oe_enable_call_latency_histograms(
+    oe_enclave_t* enclave,
+    bool enable);
+
+/**
+ * Get a snapshot of the latency histograms of the calls to an enclave.
+ *
+ * The histograms of all the enclave threads are summed up into one histogram
+ * per function. Calls in progress while the snapshot is taken may be
+ * partially accounted for.
+ *
+ * @param[in] enclave The enclave.
+ * @param[in] direction Whether to get the histograms of the ECALLs or of the
+ * OCALLs.
+ * @param[out] histograms The histograms, indexed by function id.
+ * @param[in,out] count On input, the number of elements of **histograms**.
+ * On output, the number of ECALL or OCALL functions of the enclave.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER a parameter is invalid.
+ * @returns OE_BUFFER_TOO_SMALL **histograms** is too small, in which case
+ * **count** is set to the number of elements needed.
+ * @returns OE_UNSUPPORTED the enclave type does not support the histograms.
+ *
+ */
+oe_result_t oe_get_call_latency_histograms(
+    oe_enclave_t* enclave,
+    oe_call_direction_t direction,
+    oe_call_latency_histogram_t* histograms,
+    size_t* count);
+
+/**
+ * Reset the latency histograms of the calls to an enclave.
+ *
+ * The snapshots taken afterwards only account for the calls that complete
+ * after the reset. Resetting does not stop threads from measuring calls.
+ *
+ * @param[in] enclave The enclave.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER a parameter is invalid.
+ * @returns OE_UNSUPPORTED the enclave type does not support the histograms.
+ *
+ */
+oe_result_t oe_reset_call_latency_histograms(oe_enclave_t* enclave);
+
+/**
+ * Get the memory usage statistics of the heap of an enclave.
+ *
+ * The statistics are those returned by oe_allocator_get_stats() in the
+ * enclave: the current and peak allocated sizes, the high-water mark of the
+ * heap, and the allocation counters by size and by enclave thread. They help
+ * choose the number of heap pages of an enclave.
+ *
+ * The enclave must import oe_get_allocator_stats_ecall from
+ * openenclave/edl/memory.edl.
+ *
+ * @param[in] enclave The enclave.
+ * @param[out] stats The statistics.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER a parameter is invalid.
+ * @returns OE_UNSUPPORTED the enclave does not import the ECALL or its
+ * allocator does not provide the statistics.
+ *
+ */
+oe_result_t oe_get_allocator_stats(
+    oe_enclave_t* enclave,
+    oe_allocator_stats_t* stats);
+
+/**
+ * Enable or disable the cache of enclave measurements of this process.
+ *
+ * Creating an enclave measures every page added to it to compute its
+ * MRENCLAVE. When the cache is enabled, the MRENCLAVE of an enclave is
+ * remembered, keyed by the hash of its image and of its properties, and
+ * creating the same enclave again skips the measurement of its pages. This
+ * helps processes that repeatedly create enclaves with large heaps from the
+ * same image. The cache is kept in memory only and is disabled by default.
+ * Disabling it forgets the measurements it holds.
+ *
+ * @param[in] enable Whether to enable the cache.
+ *
+ * @returns OE_OK on success.
+ *
+ */
+oe_result_t oe_enable_measurement_cache(bool enable);
+
 #if (OE_API_VERSION < 2)
 #error "Only OE_API_VERSION of 2 is supported"
 #else
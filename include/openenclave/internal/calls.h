@@ -75,6 +75,8 @@ typedef enum _oe_func
     OE_ECALL_INIT_ENCLAVE,
     OE_ECALL_CALL_ENCLAVE_FUNCTION,
     OE_ECALL_VIRTUAL_EXCEPTION_HANDLER,
+    OE_ECALL_CALL_ENCLAVE_FUNCTIONS,
+    OE_ECALL_CALL_ENCLAVE_FUNCTION_INLINE,
     /* Caution: always add new ECALL function numbers here */
     OE_ECALL_MAX,
 
@@ -84,6 +86,7 @@ typedef enum _oe_func
     OE_OCALL_MALLOC,
     OE_OCALL_FREE,
     OE_OCALL_GET_TIME,
+    OE_OCALL_CALL_HOST_FUNCTIONS,
     /* Caution: always add new OCALL function numbers here */
     OE_OCALL_MAX, /* This value is never used */
 
@@ -190,6 +193,56 @@ typedef struct _oe_call_enclave_function_args
     oe_result_t result;
 } oe_call_enclave_function_args_t;
 
+/*
+**==============================================================================
+**
+** oe_call_enclave_functions_args_t
+**
+**     Argument of OE_ECALL_CALL_ENCLAVE_FUNCTIONS. The enclave dispatches the
+**     calls in order and sets the result field of each of them.
+**
+**==============================================================================
+*/
+
+typedef struct _oe_call_enclave_functions_args
+{
+    oe_call_enclave_function_args_t* calls;
+    size_t num_calls;
+} oe_call_enclave_functions_args_t;
+
+/*
+**==============================================================================
+**
+** oe_call_enclave_function_inline_args_t
+**
+**     Argument of OE_ECALL_CALL_ENCLAVE_FUNCTION_INLINE, used for the ECALLs
+**     whose marshaled input and output fit together in the buffer field. The
+**     input starts at the beginning of the buffer and the output at the
+**     offset given by OE_CALL_INLINE_OUTPUT_OFFSET(), so that the enclave
+**     copies the arguments and the buffer in one go instead of validating
+**     and copying separate host buffers.
+**
+**==============================================================================
+*/
+
+#define OE_CALL_INLINE_BUFFER_SIZE 256
+#define OE_CALL_INLINE_BUFFER_ALIGNMENT 16
+
+#define OE_CALL_INLINE_OUTPUT_OFFSET(INPUT_SIZE)            \
+    (((INPUT_SIZE) + OE_CALL_INLINE_BUFFER_ALIGNMENT - 1) & \
+     ~((size_t)OE_CALL_INLINE_BUFFER_ALIGNMENT - 1))
+
+typedef struct _oe_call_enclave_function_inline_args
+{
+    uint64_t function_id;
+    size_t input_buffer_size;
+    size_t output_buffer_size;
+    size_t output_bytes_written;
+    oe_result_t result;
+    OE_ALIGNED(OE_CALL_INLINE_BUFFER_ALIGNMENT)
+    uint8_t buffer[OE_CALL_INLINE_BUFFER_SIZE];
+} oe_call_enclave_function_inline_args_t;
+
 /*
 **==============================================================================
 **
@@ -209,6 +262,23 @@ typedef struct _oe_call_host_function_args
     oe_result_t result;
 } oe_call_host_function_args_t;
 
+/*
+**==============================================================================
+**
+** oe_call_host_functions_args_t
+**
+**     Argument of OE_OCALL_CALL_HOST_FUNCTIONS. The host dispatches the calls
+**     in order and sets the result field of each of them.
+**
+**==============================================================================
+*/
+
+typedef struct _oe_call_host_functions_args
+{
+    oe_call_host_function_args_t* calls;
+    size_t num_calls;
+} oe_call_host_functions_args_t;
+
 /*
 **==============================================================================
 **
@@ -226,6 +296,20 @@ oe_result_t oe_call_host_function_internal(
     size_t* output_bytes_written,
     bool switchless);
 
+/*
+**==============================================================================
+**
+** oe_is_switchless_initialized()
+**
+** Return whether host workers serve the switchless ocalls of the enclave.
+** Until then, and on platforms without switchless calls, switchless ocalls
+** are performed as regular ocalls.
+**
+**==============================================================================
+*/
+
+bool oe_is_switchless_initialized(void);
+
 /**
  * Perform a low-level enclave function call (ECALL).
  *
@@ -21,6 +21,17 @@ typedef struct _oe_ecall_context
     uint64_t debug_eexit_rip;
     uint64_t debug_eexit_rbp;
     uint64_t debug_eexit_rsp;
+
+    // OCALLs that did not fit in ocall_buffer during the ECALL, and the size
+    // of the largest of them. Used by the host to grow the buffer.
+    uint64_t ocall_buffer_misses;
+    uint64_t ocall_buffer_miss_size;
+
+    // Process-unique id of the host thread making the ECALL. Unlike thread
+    // handles, ids are never reused by a later thread. Used by enclaves that
+    // keep their thread-local storage across ECALLs to detect that a TCS
+    // moved to another host thread.
+    uint64_t host_thread;
 } oe_ecall_context_t;
 
 /**
@@ -34,6 +45,12 @@ oe_call_host_function_args_t* oe_ecall_context_get_ocall_args();
  */
 void* oe_ecall_context_get_ocall_buffer(uint64_t size);
 
+/**
+ * Get the host thread making the current ECALL, or zero if no ecall context
+ * has been passed in.
+ */
+uint64_t oe_ecall_context_get_host_thread(void);
+
 OE_EXTERNC_END
 
 #endif /* _OE_INTERNAL_ECALL_CONTEXT_H */
@@ -81,7 +81,7 @@ oe_thread_data_t* oe_get_thread_data(void);
  * Due to the inability to use OE_OFFSETOF on a struct while defining its
  * members, this value is computed and hard-coded.
  */
-#define OE_THREAD_SPECIFIC_DATA_SIZE (3744)
+#define OE_THREAD_SPECIFIC_DATA_SIZE (3552)
 
 typedef struct _oe_callsite oe_callsite_t;
 
@@ -92,18 +92,40 @@ typedef struct _oe_tls_atexit
     void* object;
 } oe_tls_atexit_t;
 
+#define OE_SHARED_MEMORY_ARENA_MAX_CHUNKS 8
+
+/* A host buffer of a shared memory arena */
+typedef struct _oe_shared_memory_arena_chunk_t
+{
+    uint8_t* buffer;
+    uint64_t capacity;
+} oe_shared_memory_arena_chunk_t;
+
 /* This structure manages a pool of shared memory (memory visible to both
  * the enclave and the host). An instance of this structure is maintained
  * for each thread. This structure is used in enclave/core/arena.c.
  */
 typedef struct _oe_shared_memory_arena_t
 {
-    uint8_t* buffer;
-    uint64_t capacity;
+    /* Host buffers in allocation order. The offsets of the arena run through
+     * them one after the other. */
+    oe_shared_memory_arena_chunk_t chunks[OE_SHARED_MEMORY_ARENA_MAX_CHUNKS];
+    uint64_t num_chunks;
+
+    /* Index of the chunk that contains offset `used`, and its first offset */
+    uint64_t current;
+    uint64_t current_start;
+
     uint64_t used;
+
+    /* Number of asynchronous switchless calls still referring to the arena */
+    uint64_t pinned;
+
+    /* Allocations below this offset are kept alive while pinned */
+    uint64_t floor;
 } oe_shared_memory_arena_t;
 
-OE_CHECK_SIZE(sizeof(oe_shared_memory_arena_t), 24);
+OE_CHECK_SIZE(sizeof(oe_shared_memory_arena_t), 176);
 
 OE_PACK_BEGIN
 typedef struct _td
@@ -163,6 +185,22 @@ typedef struct _td
     oe_tls_atexit_t* tls_atexit_functions;
     uint64_t num_tls_atexit_functions;
 
+    /* ECALL marshaling buffer reused across ECALLs, the number of its
+     * leading bytes that ECALLs may have written, and whether an ECALL is
+     * using it (see enclave/core/sgx/calls.c) */
+    uint8_t* ecall_buffer;
+    uint64_t ecall_buffer_size;
+    uint32_t ecall_buffer_dirty_size;
+    uint32_t ecall_buffer_in_use;
+
+    /* Host thread the thread-local storage is bound to, whether it is bound,
+     * and whether to reinitialize it when the outermost ECALL returns. Only
+     * used by enclaves that keep their thread-local storage across ECALLs
+     * (see OE_SET_ENCLAVE_SGX_PERSISTENT_THREAD_LOCALS) */
+    uint64_t thread_locals_host_thread;
+    uint32_t thread_locals_bound;
+    uint32_t thread_locals_reset;
+
     /* Reserved for thread specific data. */
     uint8_t thread_specific_data[OE_THREAD_SPECIFIC_DATA_SIZE];
 } oe_sgx_td_t;
@@ -61,6 +61,11 @@ struct _oe_sgx_load_context
     /* Hash context used to measure enclave as it is loaded */
     oe_sha256_context_t hash_context;
 
+    /* MRENCLAVE found in the measurement cache. When set, the pages are
+     * loaded without being measured and this MRENCLAVE is used instead */
+    bool use_cached_mrenclave;
+    OE_SHA256 cached_mrenclave;
+
 #ifdef OE_WITH_EXPERIMENTAL_EEID
     /* EEID data needed during enclave creation */
     oe_eeid_t* eeid;
@@ -10,23 +10,64 @@
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/thread.h>
 
+/**
+ * Number of slots in the request ring of each host worker. Must be a power of
+ * two and match the array size declared in switchless.edl.
+ */
+#define OE_SWITCHLESS_RING_SIZE 8
+
+OE_STATIC_ASSERT(
+    (OE_SWITCHLESS_RING_SIZE & (OE_SWITCHLESS_RING_SIZE - 1)) == 0);
+
+/**
+ * Size of a cache line. Worker contexts are allocated on cache line
+ * boundaries and padded to whole cache lines.
+ */
+#define OE_SWITCHLESS_CACHE_LINE_SIZE 64
+
+/**
+ * oe_switchless_call_slot_t is used both by the host (windows/linux) and the
+ * enclave (ELF). Lock down the layout.
+ */
+OE_STATIC_ASSERT(
+    sizeof(oe_switchless_call_slot_t) == OE_SWITCHLESS_CACHE_LINE_SIZE);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_switchless_call_slot_t, sequence) == 0);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_switchless_call_slot_t, call_arg) == 8);
+
 /**
  * oe_host_worker_context_t is used both by the host (windows/linux) and the
  * enclave (ELF). Lock down the layout.
  */
-OE_STATIC_ASSERT(sizeof(oe_host_worker_context_t) == 40);
-OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, call_arg) == 0);
-OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, enc) == 8);
-OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, is_stopping) == 16);
-OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, event) == 20);
-OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, spin_count) == 24);
-OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, total_spin_count) == 32);
+OE_STATIC_ASSERT(sizeof(oe_host_worker_context_t) == 704);
+OE_STATIC_ASSERT(
+    sizeof(oe_host_worker_context_t) % OE_SWITCHLESS_CACHE_LINE_SIZE == 0);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, enc) == 0);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, is_stopping) == 8);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, event) == 12);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, spin_count) == 16);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, total_spin_count) == 24);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, ring_head) == 32);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, ring_tail) == 64);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, ring) == 128);
+OE_STATIC_ASSERT(
+    sizeof(((oe_host_worker_context_t*)0)->ring) ==
+    OE_SWITCHLESS_RING_SIZE * sizeof(oe_switchless_call_slot_t));
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, missed_count) == 640);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, call_count) == 648);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, busy_time) == 656);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, is_active) == 664);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, wake_count) == 672);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, spin_time) == 680);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, sleep_time) == 688);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, queue_time) == 696);
 
 /**
  * oe_enclave_worker_context_t is used both by the host (windows/linux) and the
  * enclave (ELF). Lock down the layout.
  */
-OE_STATIC_ASSERT(sizeof(oe_enclave_worker_context_t) == 48);
+OE_STATIC_ASSERT(sizeof(oe_enclave_worker_context_t) == 128);
+OE_STATIC_ASSERT(
+    sizeof(oe_enclave_worker_context_t) % OE_SWITCHLESS_CACHE_LINE_SIZE == 0);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, call_arg) == 0);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, enc) == 8);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, is_stopping) == 16);
@@ -36,6 +77,39 @@ OE_STATIC_ASSERT(
     OE_OFFSETOF(oe_enclave_worker_context_t, spin_count_threshold) == 32);
 OE_STATIC_ASSERT(
     OE_OFFSETOF(oe_enclave_worker_context_t, total_spin_count) == 40);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, missed_count) == 48);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, call_count) == 56);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, busy_time) == 64);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, is_active) == 72);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, wake_count) == 80);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, sleep_time) == 88);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, waiting_call) == 96);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_enclave_worker_context_t, caller_event) == 104);
+
+/**
+ * Load of a pool of switchless workers, summed over its workers.
+ */
+typedef struct _oe_switchless_pool_load
+{
+    uint64_t call_count;
+    uint64_t missed_count;
+    uint64_t busy_time;
+} oe_switchless_pool_load_t;
+
+/**
+ * State of an elastic pool of switchless workers. Workers [0, num_active)
+ * are active; the others are parked.
+ */
+typedef struct _oe_switchless_pool
+{
+    size_t min_workers;
+    size_t num_active_workers;
+
+    /* Load and time (in nanoseconds) at the last adjustment. */
+    oe_switchless_pool_load_t last_load;
+    uint64_t last_time;
+} oe_switchless_pool_t;
 
 typedef struct _oe_switchless_call_manager
 {
@@ -46,6 +120,22 @@ typedef struct _oe_switchless_call_manager
     oe_enclave_worker_context_t* enclave_worker_contexts;
     oe_thread_t* enclave_worker_threads;
     size_t num_enclave_workers;
+
+    /* Elastic pools. The monitor thread runs only if a pool is elastic. */
+    oe_switchless_pool_t host_worker_pool;
+    oe_switchless_pool_t enclave_worker_pool;
+    uint32_t target_utilization;
+    uint32_t adjust_interval_msec;
+    oe_thread_t monitor_thread;
+    bool is_monitor_stopping;
+    int32_t monitor_event;
+
+    /* Time (in nanoseconds) at which the workers were started. */
+    uint64_t start_time;
+
+    /* Time (in nanoseconds) a host thread spins on a switchless ecall before
+     * blocking, or OE_UINT64_MAX to spin until the call completes. */
+    uint64_t ecall_spin_budget;
 } oe_switchless_call_manager_t;
 
 oe_result_t oe_start_switchless_manager(
@@ -53,6 +143,15 @@ oe_result_t oe_start_switchless_manager(
     size_t num_host_workers,
     size_t num_enclave_workers);
 
+/* Declared in openenclave/host.h, which enclaves do not include. */
+struct _oe_enclave_setting_context_switchless_elastic;
+struct _oe_enclave_setting_context_switchless_placement;
+
+oe_result_t oe_start_elastic_switchless_manager(
+    oe_enclave_t* enclave,
+    const struct _oe_enclave_setting_context_switchless_elastic* setting,
+    const struct _oe_enclave_setting_context_switchless_placement* placement);
+
 oe_result_t oe_stop_switchless_manager(oe_enclave_t* enclave);
 
 void oe_host_worker_wait(oe_host_worker_context_t* context);
@@ -63,4 +162,39 @@ void oe_enclave_worker_wait(oe_enclave_worker_context_t* context);
 
 void oe_enclave_worker_wake(oe_enclave_worker_context_t* context);
 
+/**
+ * Block the host thread waiting on a switchless ecall until the worker sets
+ * caller_event. May return spuriously.
+ */
+void oe_switchless_caller_wait(oe_enclave_worker_context_t* context);
+
+void oe_switchless_caller_wake(oe_enclave_worker_context_t* context);
+
+/**
+ * Wait until the manager's monitor is woken or the timeout expires.
+ */
+void oe_switchless_monitor_wait(
+    oe_switchless_call_manager_t* manager,
+    uint32_t timeout_msec);
+
+void oe_switchless_monitor_wake(oe_switchless_call_manager_t* manager);
+
+/**
+ * Return a monotonic time in nanoseconds.
+ */
+uint64_t oe_switchless_get_time(void);
+
+/**
+ * Pin a worker thread to the given CPU.
+ */
+oe_result_t oe_switchless_set_thread_affinity(oe_thread_t thread, uint32_t cpu);
+
+/**
+ * Allocate zeroed, page-aligned worker contexts, preferably on the given NUMA
+ * node. A negative node lets the operating system choose.
+ */
+void* oe_switchless_allocate_contexts(size_t size, int32_t numa_node);
+
+void oe_switchless_free_contexts(void* contexts, size_t size);
+
 #endif /* _OE_SWITCHLESS_H */
@@ -0,0 +1,21 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_SYSCALL_SWITCHLESS_H
+#define _OE_SYSCALL_SWITCHLESS_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/**
+ * Return whether the devices should perform their I/O with the switchless
+ * variants of the syscall ocalls, i.e. whether switchless syscalls are
+ * enabled and host workers serve the switchless ocalls of the enclave.
+ */
+bool oe_syscall_use_switchless(void);
+
+OE_EXTERNC_END
+
+#endif /* _OE_SYSCALL_SWITCHLESS_H */
@@ -135,6 +135,10 @@ OE_EXTERNC_BEGIN
 
 /* Socket message flags. */
 #define OE_MSG_CTRUNC 0x0008
+#define OE_MSG_DONTWAIT 0x0040
+
+/* Socket type flags. */
+#define OE_SOCK_NONBLOCK 000004000
 
 /* oe_shutdown() options. */
 #define OE_SHUT_RD 0
@@ -16,6 +16,7 @@
 #include <openenclave/internal/syscall/fdtable.h>
 #include <openenclave/internal/syscall/iov.h>
 #include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/syscall/switchless.h>
 #include <openenclave/internal/syscall/sys/ioctl.h>
 #include <openenclave/internal/thread.h>
 #include <openenclave/internal/trace.h>
@@ -445,6 +446,7 @@ static int _epoll_wait(
     bool locked = false;
     epoll_t* epoll = _cast_epoll(epoll_);
     oe_host_fd_t host_epfd = -1;
+    oe_result_t result;
 
     if (!epoll || !events || maxevents <= 0)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -454,12 +456,16 @@ static int _epoll_wait(
     if ((host_epfd = epoll_->ops.fd.get_host_fd(epoll_)) == -1)
         OE_RAISE_ERRNO(oe_errno);
 
-    if (oe_syscall_epoll_wait_ocall(
-            &retval, host_epfd, events, (unsigned int)maxevents, timeout) !=
-        OE_OK)
-    {
+    /* A blocking wait would hold a switchless worker for its duration. */
+    if (timeout == 0 && oe_syscall_use_switchless())
+        result = oe_syscall_epoll_wait_switchless_ocall(
+            &retval, host_epfd, events, (unsigned int)maxevents, timeout);
+    else
+        result = oe_syscall_epoll_wait_ocall(
+            &retval, host_epfd, events, (unsigned int)maxevents, timeout);
+
+    if (result != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
-    }
 
     if (retval > 0)
     {
@@ -32,6 +32,7 @@
 #include <openenclave/internal/syscall/sys/ioctl.h>
 #include <openenclave/internal/syscall/raise.h>
 #include <openenclave/internal/syscall/iov.h>
+#include <openenclave/internal/syscall/switchless.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/hexdump.h>
 #include <openenclave/internal/safecrt.h>
@@ -78,6 +79,13 @@ typedef struct _file
 
     /* The file descriptor for an open directory if non-null. */
     oe_fd_t* dir;
+
+    /* Whether the host file descriptor has O_NONBLOCK set. */
+    bool nonblocking;
+
+    /* Whether the host file is known to be a regular file (or not). */
+    bool type_known;
+    bool regular;
 } file_t;
 
 /* Created by opendir(), updated by readdir(), closed by closedir(). */
@@ -101,6 +109,36 @@ static ssize_t _hostfs_read(oe_fd_t* desc, void* buf, size_t count);
 
 static int _hostfs_close(oe_fd_t* desc);
 
+/*
+ * A switchless ocall occupies a host worker thread until it returns. A
+ * read or write on a pipe, FIFO or terminal may block indefinitely, so only
+ * regular files and non-blocking descriptors take the switchless path. The
+ * file type is looked up once, the first time it matters.
+ */
+static bool _use_switchless(file_t* file)
+{
+    if (!oe_syscall_use_switchless())
+        return false;
+
+    if (file->nonblocking)
+        return true;
+
+    if (!file->type_known)
+    {
+        struct oe_stat_t buf;
+        int retval = -1;
+
+        if (oe_syscall_fstat_ocall(&retval, file->host_fd, &buf) != OE_OK ||
+            retval != 0)
+            return false;
+
+        file->regular = OE_S_ISREG(buf.st_mode);
+        file->type_known = true;
+    }
+
+    return file->regular;
+}
+
 static oe_fd_t* _hostfs_opendir(oe_device_t* device, const char* name);
 
 static int _hostfs_closedir(oe_fd_t* desc);
@@ -358,6 +396,7 @@ static oe_fd_t* _hostfs_open_file(
             goto done;
 
         file->host_fd = retval;
+        file->nonblocking = (flags & OE_O_NONBLOCK) != 0;
     }
 
     ret = &file->base;
@@ -519,6 +558,9 @@ static int _hostfs_dup(oe_fd_t* desc, oe_fd_t** new_file_out)
             OE_RAISE_ERRNO(oe_errno);
 
         new_file->host_fd = retval;
+        new_file->nonblocking = file->nonblocking;
+        new_file->type_known = file->type_known;
+        new_file->regular = file->regular;
     }
 
     *new_file_out = &new_file->base;
@@ -537,6 +579,7 @@ static ssize_t _hostfs_read(oe_fd_t* desc, void* buf, size_t count)
 {
     ssize_t ret = -1;
     file_t* file = _cast_file(desc);
+    oe_result_t result;
 
     /*
      * According to the POSIX specification, when the count is greater
@@ -550,7 +593,13 @@ static ssize_t _hostfs_read(oe_fd_t* desc, void* buf, size_t count)
         OE_RAISE_ERRNO(OE_EINVAL);
 
     /* Call the host to perform the read(). */
-    if (oe_syscall_read_ocall(&ret, file->host_fd, buf, count) != OE_OK)
+    if (_use_switchless(file))
+        result = oe_syscall_read_switchless_ocall(
+            &ret, file->host_fd, buf, count);
+    else
+        result = oe_syscall_read_ocall(&ret, file->host_fd, buf, count);
+
+    if (result != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
     /*
@@ -615,6 +664,7 @@ static ssize_t _hostfs_write(oe_fd_t* desc, const void* buf, size_t count)
 {
     ssize_t ret = -1;
     file_t* file = _cast_file(desc);
+    oe_result_t result;
 
     /*
      * Check parameters.
@@ -629,7 +679,13 @@ static ssize_t _hostfs_write(oe_fd_t* desc, const void* buf, size_t count)
         OE_RAISE_ERRNO(OE_EINVAL);
 
     /* Call the host. */
-    if (oe_syscall_write_ocall(&ret, file->host_fd, buf, count) != OE_OK)
+    if (_use_switchless(file))
+        result = oe_syscall_write_switchless_ocall(
+            &ret, file->host_fd, buf, count);
+    else
+        result = oe_syscall_write_ocall(&ret, file->host_fd, buf, count);
+
+    if (result != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
     /*
@@ -1060,6 +1116,12 @@ static int _hostfs_fcntl(oe_fd_t* desc, int cmd, uint64_t arg)
             &ret, file->host_fd, cmd, arg, argsize, argout) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Track O_NONBLOCK to decide whether read and write may block. */
+    if (cmd == OE_F_SETFL && ret != -1)
+        file->nonblocking = (arg & OE_O_NONBLOCK) != 0;
+    else if (cmd == OE_F_GETFL && ret != -1)
+        file->nonblocking = (ret & OE_O_NONBLOCK) != 0;
+
 done:
     return ret;
 }
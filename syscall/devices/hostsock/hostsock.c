@@ -17,6 +17,7 @@
 #include <openenclave/internal/syscall/fd.h>
 #include <openenclave/internal/syscall/iov.h>
 #include <openenclave/internal/syscall/fcntl.h>
+#include <openenclave/internal/syscall/switchless.h>
 #include <openenclave/corelibc/stdlib.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/safecrt.h>
@@ -39,6 +40,7 @@ typedef struct _sock
     oe_fd_t base;
     uint32_t magic;
     oe_host_fd_t host_fd;
+    bool nonblocking;
 } sock_t;
 
 static sock_t* _new_sock(void)
@@ -78,6 +80,18 @@ done:
     return sock;
 }
 
+/*
+ * A switchless ocall occupies a host worker thread until it returns, so a
+ * recv or send that blocks on the host could starve (or deadlock) every
+ * other switchless caller. Only take the switchless path when the host
+ * call cannot block.
+ */
+static bool _use_switchless(const sock_t* sock, int flags)
+{
+    return oe_syscall_use_switchless() &&
+           (sock->nonblocking || (flags & OE_MSG_DONTWAIT));
+}
+
 static ssize_t _hostsock_read(oe_fd_t*, void* buf, size_t count);
 
 static int _hostsock_close(oe_fd_t*);
@@ -111,6 +125,7 @@ static oe_fd_t* _hostsock_device_socket(
             OE_RAISE_ERRNO_MSG(oe_errno, "retval=%ld\n", retval);
 
         new_sock->host_fd = retval;
+        new_sock->nonblocking = (type & OE_SOCK_NONBLOCK) != 0;
     }
 
     ret = &new_sock->base;
@@ -167,6 +182,8 @@ static ssize_t _hostsock_device_socketpair(
 
         pair[0]->host_fd = host_sv[0];
         pair[1]->host_fd = host_sv[1];
+        pair[0]->nonblocking = (type & OE_SOCK_NONBLOCK) != 0;
+        pair[1]->nonblocking = pair[0]->nonblocking;
     }
 
     sv[0] = &pair[0]->base;
@@ -346,6 +363,7 @@ static ssize_t _hostsock_recv(
 {
     ssize_t ret = -1;
     sock_t* sock = _cast_sock(sock_);
+    oe_result_t result;
 
     oe_errno = 0;
 
@@ -366,7 +384,14 @@ static ssize_t _hostsock_recv(
             OE_RAISE_ERRNO(OE_EINVAL);
     }
 
-    if (oe_syscall_recv_ocall(&ret, sock->host_fd, buf, count, flags) != OE_OK)
+    if (_use_switchless(sock, flags))
+        result = oe_syscall_recv_switchless_ocall(
+            &ret, sock->host_fd, buf, count, flags);
+    else
+        result =
+            oe_syscall_recv_ocall(&ret, sock->host_fd, buf, count, flags);
+
+    if (result != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
     /*
@@ -586,6 +611,7 @@ static ssize_t _hostsock_send(
 {
     ssize_t ret = -1;
     sock_t* sock = _cast_sock(sock_);
+    oe_result_t result;
 
     oe_errno = 0;
 
@@ -600,7 +626,14 @@ static ssize_t _hostsock_send(
     if (!sock || (count && !buf) || count > OE_SSIZE_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    if (oe_syscall_send_ocall(&ret, sock->host_fd, buf, count, flags) != OE_OK)
+    if (_use_switchless(sock, flags))
+        result = oe_syscall_send_switchless_ocall(
+            &ret, sock->host_fd, buf, count, flags);
+    else
+        result =
+            oe_syscall_send_ocall(&ret, sock->host_fd, buf, count, flags);
+
+    if (result != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
     /*
@@ -811,6 +844,12 @@ static int _hostsock_fcntl(oe_fd_t* sock_, int cmd, uint64_t arg)
     if (oe_syscall_fcntl_ocall(
             &ret, sock->host_fd, cmd, arg, argsize, argout) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Track O_NONBLOCK to decide whether recv and send may block. */
+    if (cmd == OE_F_SETFL && ret != -1)
+        sock->nonblocking = (arg & OE_O_NONBLOCK) != 0;
+    else if (cmd == OE_F_GETFL && ret != -1)
+        sock->nonblocking = (ret & OE_O_NONBLOCK) != 0;
 done:
 
     return ret;
@@ -844,6 +883,7 @@ static int _hostsock_dup(oe_fd_t* sock_, oe_fd_t** new_sock_out)
             OE_RAISE_ERRNO(oe_errno);
 
         new_sock->host_fd = retval;
+        new_sock->nonblocking = sock->nonblocking;
     }
 
     *new_sock_out = &new_sock->base;
@@ -45,6 +45,12 @@ oe_result_t _oe_syscall_epoll_wait_ocall(
     struct oe_epoll_event* events,
     unsigned int maxevents,
     int timeout);
+oe_result_t _oe_syscall_epoll_wait_switchless_ocall(
+    int* _retval,
+    int64_t epfd,
+    struct oe_epoll_event* events,
+    unsigned int maxevents,
+    int timeout);
 oe_result_t _oe_syscall_epoll_wake_ocall(int* _retval);
 oe_result_t _oe_syscall_epoll_ctl_ocall(
     int* _retval,
@@ -82,6 +88,24 @@ oe_result_t _oe_syscall_epoll_wait_ocall(
 }
 OE_WEAK_ALIAS(_oe_syscall_epoll_wait_ocall, oe_syscall_epoll_wait_ocall);
 
+oe_result_t _oe_syscall_epoll_wait_switchless_ocall(
+    int* _retval,
+    int64_t epfd,
+    struct oe_epoll_event* events,
+    unsigned int maxevents,
+    int timeout)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(epfd);
+    OE_UNUSED(events);
+    OE_UNUSED(maxevents);
+    OE_UNUSED(timeout);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(
+    _oe_syscall_epoll_wait_switchless_ocall,
+    oe_syscall_epoll_wait_switchless_ocall);
+
 oe_result_t _oe_syscall_epoll_wake_ocall(int* _retval)
 {
     OE_UNUSED(_retval);
@@ -140,6 +164,16 @@ oe_result_t _oe_syscall_write_ocall(
     oe_host_fd_t fd,
     const void* buf,
     size_t count);
+oe_result_t _oe_syscall_read_switchless_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count);
+oe_result_t _oe_syscall_write_switchless_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count);
 oe_result_t _oe_syscall_readv_ocall(
     ssize_t* _retval,
     oe_host_fd_t fd,
@@ -267,6 +301,38 @@ oe_result_t _oe_syscall_write_ocall(
 }
 OE_WEAK_ALIAS(_oe_syscall_write_ocall, oe_syscall_write_ocall);
 
+oe_result_t _oe_syscall_read_switchless_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(fd);
+    OE_UNUSED(buf);
+    OE_UNUSED(count);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(
+    _oe_syscall_read_switchless_ocall,
+    oe_syscall_read_switchless_ocall);
+
+oe_result_t _oe_syscall_write_switchless_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(fd);
+    OE_UNUSED(buf);
+    OE_UNUSED(count);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(
+    _oe_syscall_write_switchless_ocall,
+    oe_syscall_write_switchless_ocall);
+
 oe_result_t _oe_syscall_readv_ocall(
     ssize_t* _retval,
     oe_host_fd_t fd,
@@ -681,6 +747,12 @@ oe_result_t _oe_syscall_recv_ocall(
     void* buf,
     size_t len,
     int flags);
+oe_result_t _oe_syscall_recv_switchless_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t sockfd,
+    void* buf,
+    size_t len,
+    int flags);
 oe_result_t _oe_syscall_recvfrom_ocall(
     ssize_t* _retval,
     oe_host_fd_t sockfd,
@@ -696,6 +768,12 @@ oe_result_t _oe_syscall_send_ocall(
     const void* buf,
     size_t len,
     int flags);
+oe_result_t _oe_syscall_send_switchless_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t sockfd,
+    const void* buf,
+    size_t len,
+    int flags);
 oe_result_t _oe_syscall_sendto_ocall(
     ssize_t* _retval,
     oe_host_fd_t sockfd,
@@ -959,6 +1037,24 @@ oe_result_t _oe_syscall_recv_ocall(
 }
 OE_WEAK_ALIAS(_oe_syscall_recv_ocall, oe_syscall_recv_ocall);
 
+oe_result_t _oe_syscall_recv_switchless_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t sockfd,
+    void* buf,
+    size_t len,
+    int flags)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(sockfd);
+    OE_UNUSED(buf);
+    OE_UNUSED(len);
+    OE_UNUSED(flags);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(
+    _oe_syscall_recv_switchless_ocall,
+    oe_syscall_recv_switchless_ocall);
+
 oe_result_t _oe_syscall_recvfrom_ocall(
     ssize_t* _retval,
     oe_host_fd_t sockfd,
@@ -997,6 +1093,24 @@ oe_result_t _oe_syscall_send_ocall(
 }
 OE_WEAK_ALIAS(_oe_syscall_send_ocall, oe_syscall_send_ocall);
 
+oe_result_t _oe_syscall_send_switchless_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t sockfd,
+    const void* buf,
+    size_t len,
+    int flags)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(sockfd);
+    OE_UNUSED(buf);
+    OE_UNUSED(len);
+    OE_UNUSED(flags);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(
+    _oe_syscall_send_switchless_ocall,
+    oe_syscall_send_switchless_ocall);
+
 oe_result_t _oe_syscall_sendto_ocall(
     ssize_t* _retval,
     oe_host_fd_t sockfd,
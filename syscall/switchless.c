@@ -0,0 +1,20 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/bits/module.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/syscall/switchless.h>
+
+static bool _use_switchless;
+
+oe_result_t oe_set_switchless_syscalls(bool enabled)
+{
+    __atomic_store_n(&_use_switchless, enabled, __ATOMIC_RELEASE);
+    return OE_OK;
+}
+
+bool oe_syscall_use_switchless(void)
+{
+    return __atomic_load_n(&_use_switchless, __ATOMIC_ACQUIRE) &&
+           oe_is_switchless_initialized();
+}
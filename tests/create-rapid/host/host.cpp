@@ -162,5 +162,12 @@ int main(int argc, const char* argv[])
     _test_multithreaded(argv[1], flags, false);
     _test_multithreaded(argv[1], flags, true);
 
+    // Test enclave creation with the measurement cache, which only measures
+    // the pages of the first enclave.
+    OE_TEST(oe_enable_measurement_cache(true) == OE_OK);
+    _test_sequential(argv[1], flags, true);
+    _test_multithreaded(argv[1], flags, true);
+    OE_TEST(oe_enable_measurement_cache(false) == OE_OK);
+
     return 0;
 }
@@ -2,8 +2,10 @@
 // Licensed under the MIT License.
 
 #include <openenclave/corelibc/string.h>
+#include <openenclave/debugmalloc.h>
 #include <openenclave/enclave.h>
 #include <openenclave/internal/print.h>
+#include <openenclave/internal/tests.h>
 #include <stdlib.h>
 #include "debug_malloc_t.h"
 
@@ -22,6 +24,36 @@ void enc_cleanup_memory()
     free(ptr);
 }
 
+void enc_sample_memory()
+{
+    static void* ptrs[1024];
+    uint64_t count = 0;
+    char* report = NULL;
+
+    // Sample one allocation per 4 KB allocated on average.
+    OE_TEST(oe_debug_malloc_set_sampling_interval(4096) == OE_OK);
+    OE_TEST(oe_debug_malloc_tracking_start() == OE_OK);
+
+    for (size_t i = 0; i < OE_COUNTOF(ptrs); i++)
+        OE_TEST((ptrs[i] = malloc(64)) != NULL);
+
+    // About 16 of the 1024 allocations are tracked.
+    OE_TEST(oe_debug_malloc_tracking_report(&count, &report) == OE_OK);
+    OE_TEST(count > 0 && count < OE_COUNTOF(ptrs) / 4);
+    OE_TEST(report != NULL);
+    free(report);
+
+    for (size_t i = 0; i < OE_COUNTOF(ptrs); i++)
+        free(ptrs[i]);
+
+    OE_TEST(oe_debug_malloc_tracking_report(&count, &report) == OE_OK);
+    OE_TEST(count == 0);
+    free(report);
+
+    OE_TEST(oe_debug_malloc_tracking_stop() == OE_OK);
+    OE_TEST(oe_debug_malloc_set_sampling_interval(0) == OE_OK);
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
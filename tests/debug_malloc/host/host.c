@@ -47,6 +47,18 @@ int main(int argc, const char* argv[])
         // No leaks will be reported.
         OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
     }
+    {
+        // Create enclave, track a sample of the allocations, and free them.
+        if ((result = oe_create_debug_malloc_enclave(
+                 argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) !=
+            OE_OK)
+            oe_put_err("oe_create_enclave(): result=%u", result);
+
+        OE_TEST(enc_sample_memory(enclave) == OE_OK);
+
+        // No leaks will be reported.
+        OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+    }
     printf("=== passed all tests (debug_malloc)\n");
 
     return 0;
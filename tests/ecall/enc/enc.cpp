@@ -151,6 +151,31 @@ void enc_test(test_args* args)
     }
 }
 
+uint64_t enc_echo_bytes(
+    const unsigned char* in,
+    unsigned char* out,
+    size_t size)
+{
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        out[i] = in[i];
+        sum += in[i];
+    }
+
+    return sum;
+}
+
+static uint64_t _total;
+
+/* Add to a running total, which tells the order of batched calls */
+uint64_t enc_accumulate(uint64_t value)
+{
+    _total += value;
+    return _total;
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
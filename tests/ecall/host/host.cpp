@@ -9,6 +9,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 #include "ecall_u.h"
 
 #if 0
@@ -59,6 +60,127 @@ void TestECall(oe_enclave_t* enclave)
     prev = args.thread_data.last_sp;
 }
 
+// Exercise ECALLs around the size limit of the inline ECALL arguments.
+void TestEchoBytes(oe_enclave_t* enclave)
+{
+    const size_t sizes[] = {0, 1, 15, 16, 17, 64, 96, 100, 112, 128, 200, 1024};
+    unsigned char in[1024];
+    unsigned char out[1024];
+
+    for (size_t i = 0; i < sizeof(in); i++)
+        in[i] = (unsigned char)(i * 7 + 3);
+
+    for (size_t i = 0; i < OE_COUNTOF(sizes); i++)
+    {
+        uint64_t sum = 0;
+        uint64_t expected = 0;
+
+        for (size_t j = 0; j < sizes[i]; j++)
+            expected += in[j];
+
+        memset(out, 0, sizeof(out));
+        OE_TEST(enc_echo_bytes(enclave, &sum, in, out, sizes[i]) == OE_OK);
+        OE_TEST(sum == expected);
+        OE_TEST(memcmp(in, out, sizes[i]) == 0);
+        OE_TEST(sizes[i] == sizeof(out) || out[sizes[i]] == 0);
+    }
+}
+
+static uint64_t _accumulate_id = OE_GLOBAL_ECALL_ID_NULL;
+
+// Marshal a call to enc_accumulate() the way the generated stub does. The
+// buffer holds the input and the output arguments.
+static void _init_accumulate_call(
+    oe_enclave_function_call_t* call,
+    std::vector<uint8_t>& buffer,
+    uint64_t value)
+{
+    size_t size = 0;
+    enc_accumulate_args_t args;
+
+    OE_TEST(oe_add_size(&size, sizeof(args)) == OE_OK);
+    buffer.assign(2 * size, 0);
+
+    memset(&args, 0, sizeof(args));
+    args.value = value;
+    memcpy(buffer.data(), &args, sizeof(args));
+
+    call->global_id = &_accumulate_id;
+    call->name = __ecall_ecall_info_table[ecall_fcn_id_enc_accumulate].name;
+    call->input_buffer = buffer.data();
+    call->input_buffer_size = size;
+    call->output_buffer = buffer.data() + size;
+    call->output_buffer_size = size;
+    call->output_bytes_written = 0;
+    call->result = OE_UNEXPECTED;
+}
+
+static void _test_accumulated(
+    const oe_enclave_function_call_t* call,
+    uint64_t expected)
+{
+    const enc_accumulate_args_t* args =
+        (const enc_accumulate_args_t*)call->output_buffer;
+
+    OE_TEST(call->result == OE_OK);
+    OE_TEST(call->output_bytes_written == call->output_buffer_size);
+    OE_TEST(args->_result == OE_OK);
+    OE_TEST(args->_retval == expected);
+}
+
+// Exercise batches of ECALLs, which the enclave runs in order.
+void TestCallEnclaveFunctions(oe_enclave_t* enclave)
+{
+    oe_enclave_function_call_t calls[4];
+    std::vector<uint8_t> buffers[OE_COUNTOF(calls)];
+    uint64_t total = 0;
+
+    // Each call sees the total of the calls before it.
+    {
+        for (size_t i = 0; i < OE_COUNTOF(calls); i++)
+            _init_accumulate_call(&calls[i], buffers[i], i + 1);
+
+        OE_TEST(
+            oe_call_enclave_functions(enclave, calls, OE_COUNTOF(calls)) ==
+            OE_OK);
+
+        for (size_t i = 0; i < OE_COUNTOF(calls); i++)
+            _test_accumulated(&calls[i], total += i + 1);
+    }
+
+    // An unknown function fails the whole batch before the enclave is
+    // entered, so the calls before it do not run.
+    {
+        uint64_t unknown_id = OE_GLOBAL_ECALL_ID_NULL;
+
+        _init_accumulate_call(&calls[0], buffers[0], 100);
+        _init_accumulate_call(&calls[1], buffers[1], 100);
+        calls[1].global_id = &unknown_id;
+        calls[1].name = "enc_unknown";
+
+        OE_TEST(oe_call_enclave_functions(enclave, calls, 2) == OE_NOT_FOUND);
+
+        _init_accumulate_call(&calls[0], buffers[0], 0);
+        OE_TEST(oe_call_enclave_functions(enclave, calls, 1) == OE_OK);
+        _test_accumulated(&calls[0], total);
+    }
+
+    // A failing call does not stop the calls that follow it.
+    {
+        _init_accumulate_call(&calls[0], buffers[0], 5);
+        _init_accumulate_call(&calls[1], buffers[1], 100);
+        calls[1].input_buffer = NULL;
+        _init_accumulate_call(&calls[2], buffers[2], 6);
+
+        OE_TEST(oe_call_enclave_functions(enclave, calls, 3) == OE_OK);
+
+        _test_accumulated(&calls[0], total += 5);
+        OE_TEST(calls[1].result == OE_INVALID_PARAMETER);
+        OE_TEST(calls[1].output_bytes_written == 0);
+        _test_accumulated(&calls[2], total += 6);
+    }
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
@@ -87,6 +209,12 @@ int main(int argc, const char* argv[])
         TestECall(enclave);
     }
 
+    printf("=== TestEchoBytes()\n");
+    TestEchoBytes(enclave);
+
+    printf("=== TestCallEnclaveFunctions()\n");
+    TestCallEnclaveFunctions(enclave);
+
     if ((result = oe_terminate_enclave(enclave)) != OE_OK)
     {
         oe_put_err("oe_terminate_enclave(): result=%u", result);
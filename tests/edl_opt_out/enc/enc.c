@@ -15,6 +15,9 @@ void enc_edl_opt_out()
     /* epoll.edl */
     OE_TEST(oe_syscall_epoll_create1_ocall(NULL, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_epoll_wait_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
+    OE_TEST(
+        oe_syscall_epoll_wait_switchless_ocall(NULL, 0, NULL, 0, 0) ==
+        OE_UNSUPPORTED);
     OE_TEST(oe_syscall_epoll_wake_ocall(NULL) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_epoll_ctl_ocall(NULL, 0, 0, 0, NULL) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_epoll_close_ocall(NULL, 0) == OE_UNSUPPORTED);
@@ -22,6 +25,10 @@ void enc_edl_opt_out()
     /* fcntl.edl */
     OE_TEST(oe_syscall_read_ocall(NULL, 0, NULL, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_write_ocall(NULL, 0, NULL, 0) == OE_UNSUPPORTED);
+    OE_TEST(
+        oe_syscall_read_switchless_ocall(NULL, 0, NULL, 0) == OE_UNSUPPORTED);
+    OE_TEST(
+        oe_syscall_write_switchless_ocall(NULL, 0, NULL, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_pread_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_pwrite_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_fsync_ocall(NULL, 0) == OE_UNSUPPORTED);
@@ -65,10 +72,16 @@ void enc_edl_opt_out()
         oe_syscall_sendmsg_ocall(NULL, 0, NULL, 0, NULL, 0, 0, NULL, 0, 0) ==
         OE_UNSUPPORTED);
     OE_TEST(oe_syscall_recv_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
+    OE_TEST(
+        oe_syscall_recv_switchless_ocall(NULL, 0, NULL, 0, 0) ==
+        OE_UNSUPPORTED);
     OE_TEST(
         oe_syscall_recvfrom_ocall(NULL, 0, NULL, 0, 0, NULL, 0, NULL) ==
         OE_UNSUPPORTED);
     OE_TEST(oe_syscall_send_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
+    OE_TEST(
+        oe_syscall_send_switchless_ocall(NULL, 0, NULL, 0, 0) ==
+        OE_UNSUPPORTED);
     OE_TEST(
         oe_syscall_sendto_ocall(NULL, 0, NULL, 0, 0, NULL, 0) ==
         OE_UNSUPPORTED);
@@ -122,6 +135,7 @@ void enc_edl_opt_out()
     /* sgx/switchless.edl*/
     OE_TEST(oe_sgx_sleep_switchless_worker_ocall(NULL) == OE_UNSUPPORTED);
     OE_TEST(oe_sgx_wake_switchless_worker_ocall(NULL) == OE_UNSUPPORTED);
+    OE_TEST(oe_sgx_wake_switchless_caller_ocall(NULL) == OE_UNSUPPORTED);
 
     /* sgx/attestation */
     {
@@ -36,6 +36,13 @@ int main(int argc, const char* argv[])
     /* logging.edl */
     OE_TEST(oe_log_init_ecall(NULL, NULL, 0) == OE_UNSUPPORTED);
 
+    /* memory.edl */
+    result = OE_OK;
+    OE_TEST(
+        oe_get_allocator_stats_ecall(NULL, &result, NULL, 0) ==
+        OE_UNSUPPORTED);
+    OE_TEST(result == OE_UNSUPPORTED);
+
 #if __x86_64__ || _M_X64
 #if defined(_WIN32)
     /*
@@ -63,6 +70,18 @@ int main(int argc, const char* argv[])
         OE_UNSUPPORTED);
     OE_TEST(result == OE_UNSUPPORTED);
 
+    /* sgx/sharedmemory.edl */
+    result = OE_OK;
+    OE_TEST(
+        oe_sgx_register_shared_memory_ecall(NULL, &result, NULL, 0, NULL) ==
+        OE_UNSUPPORTED);
+    OE_TEST(result == OE_UNSUPPORTED);
+    result = OE_OK;
+    OE_TEST(
+        oe_sgx_unregister_shared_memory_ecall(NULL, &result, 0) ==
+        OE_UNSUPPORTED);
+    OE_TEST(result == OE_UNSUPPORTED);
+
     /* sgx/switchless.edl */
     result = OE_OK;
     OE_TEST(
@@ -4,6 +4,7 @@
 #include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
 #include <openenclave/internal/tests.h>
+#include "../../../enclave/core/hostheap.h"
 #include "hostcalls_t.h"
 
 void test_host_malloc(size_t in_size, void_ptr* out_ptr)
@@ -71,6 +72,90 @@ void test_host_free(void_ptr in_ptr)
     oe_host_free(in_ptr);
 }
 
+#define HOST_HEAP_PAGE_SIZE (64 * 1024)
+#define HOST_HEAP_CHUNK_SIZE (64 * HOST_HEAP_PAGE_SIZE)
+
+static void _fill(void* ptr, size_t size, unsigned char value)
+{
+    OE_TEST(ptr != NULL);
+    OE_TEST(oe_is_outside_enclave(ptr, size));
+    memset(ptr, value, size);
+}
+
+static void _check(const void* ptr, size_t size, unsigned char value)
+{
+    for (size_t i = 0; i < size; i++)
+        OE_TEST(((const unsigned char*)ptr)[i] == value);
+}
+
+/* Exercise the host heap that serves the host memory the SDK allocates for
+ * itself. The seed tells apart the calls of concurrent threads. */
+void test_host_heap(unsigned char seed)
+{
+    void* blocks[64];
+    const size_t run_sizes[] = {HOST_HEAP_PAGE_SIZE + 1,
+                                5 * HOST_HEAP_PAGE_SIZE,
+                                HOST_HEAP_CHUNK_SIZE * 3 / 4,
+                                HOST_HEAP_CHUNK_SIZE * 3 / 4,
+                                HOST_HEAP_CHUNK_SIZE * 3 / 4};
+    void* runs[OE_COUNTOF(run_sizes)];
+    void* ptr;
+
+    /* Enclaves without a host heap leave all allocations to the host */
+    if (!(ptr = oe_host_heap_malloc(1)))
+        return;
+    oe_host_free(ptr);
+
+    /* Blocks of the same size class share pages */
+    for (size_t i = 0; i < OE_COUNTOF(blocks); i++)
+    {
+        blocks[i] = oe_host_heap_malloc(100);
+        _fill(blocks[i], 100, (unsigned char)(seed + i));
+        OE_TEST(oe_host_heap_usable_size(blocks[i]) == 128);
+    }
+
+    /* Larger allocations take runs of pages, and three quarters of a chunk
+     * do not fit twice in one, so each of those adds a chunk */
+    for (size_t i = 0; i < OE_COUNTOF(runs); i++)
+    {
+        size_t pages = (run_sizes[i] + HOST_HEAP_PAGE_SIZE - 1) /
+                       HOST_HEAP_PAGE_SIZE;
+
+        runs[i] = oe_host_heap_malloc(run_sizes[i]);
+        _fill(runs[i], run_sizes[i], (unsigned char)(seed + i));
+        OE_TEST(
+            oe_host_heap_usable_size(runs[i]) == pages * HOST_HEAP_PAGE_SIZE);
+    }
+
+    /* Allocations larger than a chunk are left to the host */
+    OE_TEST(oe_host_heap_malloc(HOST_HEAP_CHUNK_SIZE + 1) == NULL);
+
+    /* No allocation overlaps another one */
+    for (size_t i = 0; i < OE_COUNTOF(blocks); i++)
+        _check(blocks[i], 100, (unsigned char)(seed + i));
+
+    for (size_t i = 0; i < OE_COUNTOF(runs); i++)
+        _check(runs[i], run_sizes[i], (unsigned char)(seed + i));
+
+    /* oe_host_realloc() keeps host heap blocks that are large enough, and
+     * moves the others within the host heap */
+    OE_TEST(oe_host_realloc(blocks[0], 128) == blocks[0]);
+
+    ptr = oe_host_realloc(blocks[0], 3 * HOST_HEAP_PAGE_SIZE);
+    OE_TEST(ptr != NULL);
+    OE_TEST(oe_host_heap_usable_size(ptr) == 3 * HOST_HEAP_PAGE_SIZE);
+    _check(ptr, 100, seed);
+
+    OE_TEST(oe_host_realloc(ptr, 0) == NULL);
+
+    /* oe_host_free() gives the memory back to the host heap */
+    for (size_t i = 1; i < OE_COUNTOF(blocks); i++)
+        oe_host_free(blocks[i]);
+
+    for (size_t i = 0; i < OE_COUNTOF(runs); i++)
+        oe_host_free(runs[i]);
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
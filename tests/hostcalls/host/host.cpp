@@ -5,6 +5,8 @@
 #include <openenclave/internal/error.h>
 #include <openenclave/internal/tests.h>
 #include <cstring>
+#include <thread>
+#include <vector>
 #include "hostcalls_u.h"
 
 static void _test_host_malloc(oe_enclave_t* enclave)
@@ -181,6 +183,21 @@ static void _test_host_strndup(oe_enclave_t* enclave)
     OE_TEST(test_host_free(enclave, out_str) == OE_OK);
 }
 
+static void _test_host_heap(oe_enclave_t* enclave)
+{
+    std::vector<std::thread> threads;
+
+    OE_TEST(test_host_heap(enclave, 0) == OE_OK);
+
+    /* Threads that grow the host heap at the same time each add a chunk */
+    for (unsigned char i = 1; i <= 4; i++)
+        threads.emplace_back(
+            [enclave, i]() { OE_TEST(test_host_heap(enclave, i) == OE_OK); });
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
@@ -202,6 +219,7 @@ int main(int argc, const char* argv[])
     _test_host_calloc(enclave);
     _test_host_realloc(enclave);
     _test_host_strndup(enclave);
+    _test_host_heap(enclave);
 
     oe_terminate_enclave(enclave);
 
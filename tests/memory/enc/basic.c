@@ -8,6 +8,7 @@
 #include <malloc.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "memory_t.h"
 
@@ -54,6 +55,21 @@ void test_calloc(void)
         OE_TEST(ptr[i] == 0);
     free(ptr);
 
+    /* Blocks reused after a free are cleared too. */
+    for (size_t size = 1; size <= 2048; size *= 2)
+    {
+        unsigned char* bytes = (unsigned char*)malloc(size);
+        OE_TEST(bytes != NULL);
+        memset(bytes, 0xff, size);
+        free(bytes);
+
+        bytes = (unsigned char*)calloc(1, size);
+        OE_TEST(bytes != NULL);
+        for (size_t i = 0; i < size; i++)
+            OE_TEST(bytes[i] == 0);
+        free(bytes);
+    }
+
     /* Ensure that calloc fails. */
     ptr = (int*)calloc(1, ~((size_t)0));
     OE_TEST(ptr == NULL);
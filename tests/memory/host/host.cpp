@@ -141,6 +141,42 @@ static void _malloc_random_size_fragment_test(oe_enclave_t* enclave, int seed)
     test_malloc_random_size_fragment(enclave, chosen_seed);
 }
 
+static void _malloc_stats_test(oe_enclave_t* enclave)
+{
+    static oe_allocator_stats_t stats;
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t size_classes = 0;
+
+    OE_TEST(oe_get_allocator_stats(enclave, NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_get_allocator_stats(enclave, &stats) == OE_OK);
+
+    OE_TEST(
+        stats.current_allocated_heap_size <= stats.peak_allocated_heap_size);
+    OE_TEST(stats.peak_allocated_heap_size <= stats.heap_high_water_mark);
+    OE_TEST(stats.heap_high_water_mark > 0);
+    OE_TEST(stats.heap_high_water_mark <= stats.max_total_heap_size);
+    OE_TEST(stats.num_threads <= OE_ALLOCATOR_STATS_MAX_THREADS);
+
+    /* Not every allocator counts allocations by thread */
+    if (!stats.num_threads)
+        return;
+
+    for (size_t i = 0; i < stats.num_threads; i++)
+    {
+        allocations += stats.threads[i].allocations;
+        frees += stats.threads[i].frees;
+    }
+
+    for (size_t c = 0; c < OE_ALLOCATOR_STATS_SIZE_CLASSES; c++)
+        size_classes += stats.size_classes[c];
+
+    /* The tests allocated blocks of all sizes and freed most of them */
+    OE_TEST(allocations > 0 && frees > 0);
+    OE_TEST(size_classes >= allocations);
+    OE_TEST(stats.size_classes[0] > 0);
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
@@ -188,6 +224,9 @@ int main(int argc, const char* argv[])
     }
     _malloc_random_size_fragment_test(enclave, seed);
 
+    printf("===Starting malloc stats test.\n");
+    _malloc_stats_test(enclave);
+
     printf("===All tests pass.\n");
 
     oe_terminate_enclave(enclave);
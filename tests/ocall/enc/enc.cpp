@@ -10,6 +10,8 @@
 #include <openenclave/internal/globals.h>
 #include <openenclave/internal/tests.h>
 #include <openenclave/internal/thread.h>
+#include <stdlib.h>
+#include <string.h>
 #include "ocall_t.h"
 
 uint64_t enc_test2(uint64_t val)
@@ -103,3 +105,125 @@ OE_SET_ENCLAVE_SGX(
     1024, /* NumHeapPages */
     128,  /* NumStackPages */
     16);  /* NumTCS */
+
+uint64_t enc_test_large_ocall(size_t size)
+{
+    unsigned char* buffer = (unsigned char*)malloc(size);
+    uint64_t ret_val = 0;
+    OE_TEST(buffer != NULL);
+
+    for (size_t i = 0; i < size; i++)
+        buffer[i] = (unsigned char)i;
+
+    OE_TEST(host_sum_buffer(&ret_val, buffer, size) == OE_OK);
+    free(buffer);
+    return ret_val;
+}
+
+#define BATCH_BUFFER_SIZE 16
+
+typedef struct _batch_buffers
+{
+    uint8_t input[BATCH_BUFFER_SIZE];
+    uint8_t output[BATCH_BUFFER_SIZE];
+} batch_buffers_t;
+
+static void _init_batch_call(
+    oe_host_function_call_t* call,
+    batch_buffers_t* buffers,
+    size_t function_id,
+    uint8_t value)
+{
+    memset(buffers->input, value, sizeof(buffers->input));
+    memset(buffers->output, 0, sizeof(buffers->output));
+
+    call->function_id = function_id;
+    call->input_buffer = buffers->input;
+    call->input_buffer_size = sizeof(buffers->input);
+    call->output_buffer = buffers->output;
+    call->output_buffer_size = sizeof(buffers->output);
+    call->output_bytes_written = 0;
+    call->result = OE_UNEXPECTED;
+}
+
+static void _test_echoed(
+    const oe_host_function_call_t* call,
+    const batch_buffers_t* buffers)
+{
+    OE_TEST(call->result == OE_OK);
+    OE_TEST(call->output_bytes_written == sizeof(buffers->output));
+    OE_TEST(
+        memcmp(buffers->output, buffers->input, sizeof(buffers->output)) == 0);
+}
+
+void enc_test_call_host_functions()
+{
+    /* The buffers of batched calls must be in host memory */
+    const size_t num_buffers = 2048;
+    batch_buffers_t* buffers = (batch_buffers_t*)oe_host_malloc(
+        num_buffers * sizeof(batch_buffers_t));
+    oe_host_function_call_t* calls = (oe_host_function_call_t*)malloc(
+        num_buffers * sizeof(oe_host_function_call_t));
+    OE_TEST(buffers != NULL && calls != NULL);
+
+    /* A failing call does not stop the calls that follow it */
+    {
+        _init_batch_call(
+            &calls[0], &buffers[0], ocall_fcn_id_host_batch_echo, 1);
+        _init_batch_call(&calls[1], &buffers[1], 0xffff, 2);
+        _init_batch_call(
+            &calls[2], &buffers[2], ocall_fcn_id_host_batch_echo, 3);
+
+        OE_TEST(oe_call_host_functions(calls, 3) == OE_OK);
+        _test_echoed(&calls[0], &buffers[0]);
+        OE_TEST(calls[1].result == OE_NOT_FOUND);
+        OE_TEST(calls[1].output_bytes_written == 0);
+        _test_echoed(&calls[2], &buffers[2]);
+    }
+
+    /* The call descriptors of a large batch do not fit in the ocall buffer,
+     * whose size the host caps at 64KB, and go to the host heap instead */
+    {
+        for (size_t i = 0; i < num_buffers; i++)
+            _init_batch_call(
+                &calls[i],
+                &buffers[i],
+                ocall_fcn_id_host_batch_echo,
+                (uint8_t)i);
+
+        OE_TEST(oe_call_host_functions(calls, num_buffers) == OE_OK);
+
+        for (size_t i = 0; i < num_buffers; i++)
+            _test_echoed(&calls[i], &buffers[i]);
+    }
+
+    /* The host cannot claim to have written more than the output buffer */
+    {
+        _init_batch_call(
+            &calls[0], &buffers[0], ocall_fcn_id_host_batch_echo, 1);
+        _init_batch_call(
+            &calls[1], &buffers[1], ocall_fcn_id_host_batch_write_too_much, 2);
+
+        OE_TEST(oe_call_host_functions(calls, 2) == OE_OK);
+        _test_echoed(&calls[0], &buffers[0]);
+        OE_TEST(calls[1].result == OE_UNEXPECTED);
+        OE_TEST(calls[1].output_bytes_written == 0);
+    }
+
+    /* Nor can the enclave hand enclave memory to the host */
+    {
+        batch_buffers_t enclave_buffers;
+
+        _init_batch_call(
+            &calls[0], &enclave_buffers, ocall_fcn_id_host_batch_echo, 1);
+        OE_TEST(oe_call_host_functions(calls, 1) == OE_INVALID_PARAMETER);
+
+        _init_batch_call(
+            &calls[0], &buffers[0], ocall_fcn_id_host_batch_echo, 1);
+        calls[0].output_buffer = enclave_buffers.output;
+        OE_TEST(oe_call_host_functions(calls, 1) == OE_INVALID_PARAMETER);
+    }
+
+    free(calls);
+    oe_host_free(buffers);
+}
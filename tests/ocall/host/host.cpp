@@ -8,6 +8,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
+#include "../../../host/sgx/enclave.h"
 #include "ocall_u.h"
 
 uint64_t host_my_ocall(uint64_t val)
@@ -22,6 +24,60 @@ void host_func2(const unsigned char*)
     g_func2_ok = true;
 }
 
+uint64_t host_sum_buffer(const unsigned char* buffer, size_t size)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; i++)
+        sum += buffer[i];
+    return sum;
+}
+
+/* The enclave calls these only in batches. Their dispatch entries are
+ * replaced with the raw functions below. */
+void host_batch_echo()
+{
+}
+
+void host_batch_write_too_much()
+{
+}
+
+static void _batch_echo(
+    const uint8_t* input_buffer,
+    size_t input_buffer_size,
+    uint8_t* output_buffer,
+    size_t output_buffer_size,
+    size_t* output_bytes_written)
+{
+    if (output_buffer_size < input_buffer_size)
+        return;
+
+    memcpy(output_buffer, input_buffer, input_buffer_size);
+    *output_bytes_written = input_buffer_size;
+}
+
+/* Behave like a compromised host */
+static void _batch_write_too_much(
+    const uint8_t* input_buffer,
+    size_t input_buffer_size,
+    uint8_t* output_buffer,
+    size_t output_buffer_size,
+    size_t* output_bytes_written)
+{
+    OE_UNUSED(input_buffer);
+    OE_UNUSED(input_buffer_size);
+    OE_UNUSED(output_buffer);
+    *output_bytes_written = output_buffer_size + 1;
+}
+
+static uint64_t _expected_sum(size_t size)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; i++)
+        sum += (unsigned char)i;
+    return sum;
+}
+
 static oe_enclave_t* g_enclave = NULL;
 static bool g_reentrancy_tested = false;
 void host_test_reentrancy()
@@ -43,8 +99,15 @@ int main(int argc, const char* argv[])
     const uint32_t flags = oe_get_create_flags();
 
     oe_enclave_t* enclave = NULL;
+
+    /* Start with small ocall buffers so that large ocalls make them grow */
+    oe_enclave_setting_ocall_buffer_t ocall_buffer_setting = {4096, 65536};
+    oe_enclave_setting_t setting;
+    setting.setting_type = OE_ENCLAVE_SETTING_OCALL_BUFFER;
+    setting.u.ocall_buffer_setting = &ocall_buffer_setting;
+
     oe_result_t result = oe_create_ocall_enclave(
-        argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave);
+        argv[1], OE_ENCLAVE_TYPE_SGX, flags, &setting, 1, &enclave);
     if (OE_OK != result)
     {
         oe_put_err("oe_create_ocall_enclave(): result=%u", result);
@@ -107,6 +170,93 @@ int main(int argc, const char* argv[])
         OE_TEST(MY_OCALL_SEED * MY_OCALL_MULTIPLIER == ret_val);
     }
 
+    /* Call enc_test_large_ocall with sizes below, within and beyond the
+     * range the ocall buffers may grow in */
+    {
+        const size_t sizes[] = {1024, 32768, 262144};
+
+        for (size_t i = 0; i < OE_COUNTOF(sizes); i++)
+        {
+            for (size_t j = 0; j < 8; j++)
+            {
+                uint64_t ret_val = 0;
+                result = enc_test_large_ocall(enclave, &ret_val, sizes[i]);
+                OE_TEST(OE_OK == result);
+                OE_TEST(_expected_sum(sizes[i]) == ret_val);
+            }
+        }
+    }
+
+    /* Measure the latency of enc_test_large_ocall and of its OCALL */
+    {
+        const uint64_t ids[] = {ocall_fcn_id_enc_test_large_ocall,
+                                ocall_fcn_id_host_sum_buffer};
+        const oe_call_direction_t directions[] = {OE_CALL_DIRECTION_ECALL,
+                                                  OE_CALL_DIRECTION_OCALL};
+        static oe_call_latency_histogram_t histograms[256];
+
+        OE_TEST(oe_enable_call_latency_histograms(enclave, true) == OE_OK);
+
+        for (size_t j = 0; j < 8; j++)
+        {
+            uint64_t ret_val = 0;
+            result = enc_test_large_ocall(enclave, &ret_val, 1024);
+            OE_TEST(OE_OK == result);
+        }
+
+        for (size_t i = 0; i < OE_COUNTOF(directions); i++)
+        {
+            size_t count = 0;
+            uint64_t total = 0;
+
+            OE_TEST(
+                oe_get_call_latency_histograms(
+                    enclave, directions[i], NULL, &count) ==
+                OE_BUFFER_TOO_SMALL);
+            OE_TEST(count > ids[i] && count <= OE_COUNTOF(histograms));
+            OE_TEST(
+                oe_get_call_latency_histograms(
+                    enclave, directions[i], histograms, &count) == OE_OK);
+
+            OE_TEST(histograms[ids[i]].function_id == ids[i]);
+            OE_TEST(histograms[ids[i]].count == 8);
+            OE_TEST(histograms[ids[i]].total_nsec > 0);
+
+            for (size_t b = 0; b < OE_CALL_LATENCY_BUCKETS; b++)
+                total += histograms[ids[i]].buckets[b];
+            OE_TEST(total == 8);
+        }
+
+        OE_TEST(oe_reset_call_latency_histograms(enclave) == OE_OK);
+        OE_TEST(oe_enable_call_latency_histograms(enclave, false) == OE_OK);
+
+        for (size_t i = 0; i < OE_COUNTOF(directions); i++)
+        {
+            size_t count = OE_COUNTOF(histograms);
+
+            OE_TEST(
+                oe_get_call_latency_histograms(
+                    enclave, directions[i], histograms, &count) == OE_OK);
+            OE_TEST(histograms[ids[i]].count == 0);
+        }
+    }
+
+    /* Call enc_test_call_host_functions */
+    {
+        std::vector<oe_ocall_func_t> ocalls(
+            enclave->ocalls, enclave->ocalls + enclave->num_ocalls);
+        const oe_ocall_func_t* enclave_ocalls = enclave->ocalls;
+
+        ocalls[ocall_fcn_id_host_batch_echo] = _batch_echo;
+        ocalls[ocall_fcn_id_host_batch_write_too_much] = _batch_write_too_much;
+        enclave->ocalls = ocalls.data();
+
+        result = enc_test_call_host_functions(enclave);
+        OE_TEST(OE_OK == result);
+
+        enclave->ocalls = enclave_ocalls;
+    }
+
     /* Call enc_test_reentrancy */
     {
         g_enclave = enclave;
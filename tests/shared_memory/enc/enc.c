@@ -0,0 +1,103 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <stdlib.h>
+#include <string.h>
+#include "shared_memory_t.h"
+
+uint64_t enc_sum_region(uint64_t region_id, size_t chunk_size)
+{
+    uint8_t* chunk = (uint8_t*)malloc(chunk_size);
+    void* address = NULL;
+    size_t size = 0;
+    uint64_t sum = 0;
+
+    OE_TEST(chunk != NULL);
+    OE_TEST(oe_shared_memory_get(region_id, &address, &size) == OE_OK);
+    OE_TEST(oe_is_outside_enclave(address, size));
+
+    for (size_t offset = 0; offset < size; offset += chunk_size)
+    {
+        size_t n = size - offset < chunk_size ? size - offset : chunk_size;
+
+        OE_TEST(oe_shared_memory_read(region_id, offset, chunk, n) == OE_OK);
+        for (size_t i = 0; i < n; i++)
+            sum += chunk[i];
+    }
+
+    free(chunk);
+    return sum;
+}
+
+uint64_t enc_sum_region_in_place(uint64_t region_id)
+{
+    void* address = NULL;
+    size_t size = 0;
+    uint64_t sum = 0;
+
+    OE_TEST(oe_shared_memory_get(region_id, &address, &size) == OE_OK);
+
+    for (size_t i = 0; i < size; i++)
+        sum += ((const volatile uint8_t*)address)[i];
+
+    return sum;
+}
+
+oe_result_t enc_fill_region(
+    uint64_t region_id,
+    size_t chunk_size,
+    uint8_t value)
+{
+    oe_result_t result = OE_OK;
+    uint8_t* chunk = (uint8_t*)malloc(chunk_size);
+    void* address = NULL;
+    size_t size = 0;
+
+    OE_TEST(chunk != NULL);
+    memset(chunk, value, chunk_size);
+    OE_TEST(oe_shared_memory_get(region_id, &address, &size) == OE_OK);
+
+    for (size_t offset = 0; offset < size && result == OE_OK;
+         offset += chunk_size)
+    {
+        size_t n = size - offset < chunk_size ? size - offset : chunk_size;
+        result = oe_shared_memory_write(region_id, offset, chunk, n);
+    }
+
+    free(chunk);
+    return result;
+}
+
+void enc_test_bounds(uint64_t region_id)
+{
+    uint8_t byte = 0;
+    void* address = NULL;
+    size_t size = 0;
+
+    OE_TEST(oe_shared_memory_get(region_id, &address, &size) == OE_OK);
+
+    OE_TEST(oe_shared_memory_read(region_id, size - 1, &byte, 1) == OE_OK);
+    OE_TEST(
+        oe_shared_memory_read(region_id, size, &byte, 1) == OE_OUT_OF_BOUNDS);
+    OE_TEST(
+        oe_shared_memory_write(region_id, size, &byte, 1) ==
+        OE_OUT_OF_BOUNDS);
+    OE_TEST(
+        oe_shared_memory_read(region_id, OE_SIZE_MAX, &byte, 2) ==
+        OE_OUT_OF_BOUNDS);
+    OE_TEST(
+        oe_shared_memory_read(region_id, 0, NULL, 1) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(oe_shared_memory_read(region_id + 1, 0, &byte, 1) == OE_NOT_FOUND);
+    OE_TEST(oe_shared_memory_read(0, 0, &byte, 1) == OE_NOT_FOUND);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* Debug */
+    1024, /* NumHeapPages */
+    64,   /* NumStackPages */
+    2);   /* NumTCS */
@@ -0,0 +1,103 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "shared_memory_u.h"
+
+#define REGION_SIZE (4 * 1024 * 1024 + 123)
+
+static uint64_t _sum(const uint8_t* buffer, size_t size)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; i++)
+        sum += buffer[i];
+    return sum;
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    uint8_t* region = NULL;
+    uint64_t region_id = 0;
+    uint64_t other_id = 0;
+    uint64_t sum = 0;
+    oe_result_t retval = OE_UNEXPECTED;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    if ((result = oe_create_shared_memory_enclave(
+             argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    OE_TEST((region = (uint8_t*)malloc(REGION_SIZE)) != NULL);
+    for (size_t i = 0; i < REGION_SIZE; i++)
+        region[i] = (uint8_t)(i * 7);
+
+    /* Invalid registrations */
+    OE_TEST(
+        oe_register_shared_memory(enclave, NULL, 1, &region_id) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_register_shared_memory(enclave, region, 0, &region_id) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_register_shared_memory(enclave, region, 1, NULL) ==
+        OE_INVALID_PARAMETER);
+
+    OE_TEST(
+        oe_register_shared_memory(enclave, region, REGION_SIZE, &region_id) ==
+        OE_OK);
+    OE_TEST(region_id != 0);
+
+    /* Copy the region in with chunks of several sizes, and read it in place */
+    OE_TEST(enc_sum_region(enclave, &sum, region_id, 64 * 1024) == OE_OK);
+    OE_TEST(sum == _sum(region, REGION_SIZE));
+    OE_TEST(enc_sum_region(enclave, &sum, region_id, 1000) == OE_OK);
+    OE_TEST(sum == _sum(region, REGION_SIZE));
+    OE_TEST(enc_sum_region_in_place(enclave, &sum, region_id) == OE_OK);
+    OE_TEST(sum == _sum(region, REGION_SIZE));
+
+    /* Copy out */
+    OE_TEST(
+        enc_fill_region(enclave, &retval, region_id, 64 * 1024, 0x5a) ==
+        OE_OK);
+    OE_TEST(retval == OE_OK);
+    for (size_t i = 0; i < REGION_SIZE; i++)
+        OE_TEST(region[i] == 0x5a);
+
+    OE_TEST(enc_test_bounds(enclave, region_id) == OE_OK);
+
+    /* A region registered after another is unregistered does not reuse its
+     * identifier */
+    OE_TEST(oe_unregister_shared_memory(enclave, region_id) == OE_OK);
+    OE_TEST(oe_unregister_shared_memory(enclave, region_id) == OE_NOT_FOUND);
+    OE_TEST(
+        oe_register_shared_memory(enclave, region, REGION_SIZE, &other_id) ==
+        OE_OK);
+    OE_TEST(other_id != region_id);
+    OE_TEST(
+        enc_fill_region(enclave, &retval, region_id, 64 * 1024, 0) == OE_OK);
+    OE_TEST(retval == OE_NOT_FOUND);
+    OE_TEST(oe_unregister_shared_memory(enclave, other_id) == OE_OK);
+
+    free(region);
+
+    result = oe_terminate_enclave(enclave);
+    OE_TEST(result == OE_OK);
+
+    printf("=== passed all tests (shared_memory)\n");
+
+    return 0;
+}
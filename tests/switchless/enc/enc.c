@@ -5,6 +5,7 @@
 #include <openenclave/enclave.h>
 #include <openenclave/internal/print.h>
 #include <openenclave/internal/tests.h>
+#include <stdlib.h>
 #include <string.h>
 #include "switchless_test_t.h"
 
@@ -77,6 +78,218 @@ int enc_test_echo_regular(const char* in, char out[STRING_LEN], int repeats)
     return 0;
 }
 
+static int _sum_switchless(
+    const unsigned char* buffer,
+    size_t size,
+    uint64_t expected,
+    int repeats)
+{
+    for (int i = 0; i < repeats; i++)
+    {
+        uint64_t sum = 0;
+
+        if (host_sum_switchless(&sum, buffer, size) != OE_OK || sum != expected)
+            return -1;
+    }
+
+    return 0;
+}
+
+int enc_test_large_switchless(size_t size, int repeats)
+{
+    unsigned char* buffer = (unsigned char*)malloc(size);
+    uint64_t expected = 0;
+    oe_switchless_arena_statistics_t before;
+    oe_switchless_arena_statistics_t kept;
+    oe_switchless_arena_statistics_t trimmed;
+    int ret = -1;
+
+    if (!buffer)
+        return -1;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        buffer[i] = (unsigned char)i;
+        expected += buffer[i];
+    }
+
+    OE_TEST(oe_get_switchless_arena_statistics(NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_get_switchless_arena_statistics(&before) == OE_OK);
+
+    // The arena grows on the first call and is reused by the next ones.
+    if (_sum_switchless(buffer, size, expected, repeats) != 0)
+        goto done;
+
+    OE_TEST(oe_get_switchless_arena_statistics(&kept) == OE_OK);
+    OE_TEST(kept.grow_count > before.grow_count);
+    OE_TEST(kept.grow_bytes >= before.grow_bytes + size);
+    OE_TEST(kept.trim_count == before.trim_count);
+
+    // With a watermark of 0, the arena gives its extra chunks back after every
+    // call and grows again on the next one.
+    OE_TEST(oe_set_switchless_arena_watermark(0) == OE_OK);
+
+    if (_sum_switchless(buffer, size, expected, repeats) != 0)
+        goto done;
+
+    OE_TEST(oe_get_switchless_arena_statistics(&trimmed) == OE_OK);
+    OE_TEST(trimmed.grow_count >= kept.grow_count + (uint64_t)repeats - 1);
+    OE_TEST(trimmed.trim_count >= kept.trim_count + (uint64_t)repeats);
+
+    // Restore the default watermark
+    OE_TEST(oe_set_switchless_arena_watermark(16 * 1024 * 1024) == OE_OK);
+
+    ret = 0;
+
+done:
+    free(buffer);
+    return ret;
+}
+
+#define NUM_ASYNC_CALLS 8
+
+typedef struct _async_call
+{
+    oe_switchless_call_handle_t handle;
+    host_increment_switchless_args_t* input;
+    host_increment_switchless_args_t* output;
+    size_t size;
+    uint64_t value;
+} async_call_t;
+
+// Marshal host_increment_switchless(value) the way the generated stub does
+// and post it without waiting for it.
+static void _post_increment(async_call_t* call, uint64_t value)
+{
+    call->size = 0;
+    OE_TEST(oe_add_size(&call->size, sizeof(*call->input)) == OE_OK);
+
+    call->input = oe_allocate_switchless_ocall_buffer(call->size);
+    call->output = oe_allocate_switchless_ocall_buffer(call->size);
+    OE_TEST(call->input != NULL && call->output != NULL);
+
+    memset(call->input, 0, call->size);
+    memset(call->output, 0, call->size);
+    call->input->value = value;
+    call->value = value;
+
+    OE_TEST(
+        oe_switchless_call_host_function_async(
+            switchless_test_fcn_id_host_increment_switchless,
+            call->input,
+            call->size,
+            call->output,
+            call->size,
+            &call->handle) == OE_OK);
+}
+
+static void _test_incremented(
+    const async_call_t* call,
+    oe_result_t result,
+    size_t output_bytes_written)
+{
+    OE_TEST(result == OE_OK);
+    OE_TEST(output_bytes_written == call->size);
+    OE_TEST(call->input->value == call->value);
+    OE_TEST(call->output->_result == OE_OK);
+    OE_TEST(call->output->_retval == call->value + 1);
+}
+
+static bool _overlaps(const void* p, size_t size, const async_call_t* call)
+{
+    const uint8_t* start = (const uint8_t*)p;
+    const uint8_t* input = (const uint8_t*)call->input;
+    const uint8_t* output = (const uint8_t*)call->output;
+
+    return (start < input + call->size && input < start + size) ||
+           (start < output + call->size && output < start + size);
+}
+
+int enc_test_async_switchless(bool has_host_workers)
+{
+    async_call_t calls[NUM_ASYNC_CALLS];
+    oe_switchless_call_handle_t handles[NUM_ASYNC_CALLS];
+    size_t output_bytes_written = 0;
+    size_t index = 0;
+    oe_result_t result;
+    unsigned char buffer[256];
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < NUM_ASYNC_CALLS; i++)
+        _post_increment(&calls[i], 100 * i);
+
+    // Without host workers, the calls were made before being posted.
+    if (!has_host_workers)
+    {
+        for (size_t i = 0; i < NUM_ASYNC_CALLS; i++)
+        {
+            result = oe_switchless_call_poll(
+                &calls[i].handle, &output_bytes_written);
+            _test_incremented(&calls[i], result, output_bytes_written);
+        }
+
+        return 0;
+    }
+
+    // Synchronous switchless calls release their buffers when they return,
+    // but not those of the outstanding calls, which stay pinned.
+    for (size_t i = 0; i < sizeof(buffer); i++)
+    {
+        buffer[i] = (unsigned char)i;
+        sum += buffer[i];
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        uint64_t result_sum = 0;
+        void* p;
+
+        OE_TEST(
+            host_sum_switchless(&result_sum, buffer, sizeof(buffer)) == OE_OK);
+        OE_TEST(result_sum == sum);
+
+        OE_TEST((p = oe_allocate_switchless_ocall_buffer(64)) != NULL);
+        for (size_t j = 0; j < NUM_ASYNC_CALLS; j++)
+            OE_TEST(!_overlaps(p, 64, &calls[j]));
+        oe_free_switchless_ocall_buffer(p);
+    }
+
+    // Complete the first call by polling it.
+    while ((result = oe_switchless_call_poll(
+                &calls[0].handle, &output_bytes_written)) == OE_BUSY)
+        ;
+    _test_incremented(&calls[0], result, output_bytes_written);
+    OE_TEST(
+        oe_switchless_call_poll(&calls[0].handle, &output_bytes_written) ==
+        OE_INVALID_PARAMETER);
+
+    // Complete the second one by waiting for it.
+    result = oe_switchless_call_wait(&calls[1].handle, &output_bytes_written);
+    _test_incremented(&calls[1], result, output_bytes_written);
+    OE_TEST(
+        oe_switchless_call_wait(&calls[1].handle, &output_bytes_written) ==
+        OE_INVALID_PARAMETER);
+
+    // Complete the others in any order.
+    for (size_t i = 0; i < NUM_ASYNC_CALLS; i++)
+        handles[i] = calls[i].handle;
+
+    for (size_t i = 2; i < NUM_ASYNC_CALLS; i++)
+    {
+        result = oe_switchless_call_wait_any(
+            handles, NUM_ASYNC_CALLS, &index, &output_bytes_written);
+        OE_TEST(index >= 2 && index < NUM_ASYNC_CALLS);
+        _test_incremented(&calls[index], result, output_bytes_written);
+    }
+
+    OE_TEST(
+        oe_switchless_call_wait_any(
+            handles, NUM_ASYNC_CALLS, &index, &output_bytes_written) ==
+        OE_INVALID_PARAMETER);
+
+    return 0;
+}
+
 int enc_echo_switchless(
     const char* in,
     char* out,
@@ -91,6 +304,16 @@ int enc_echo_switchless(
     return 0;
 }
 
+uint64_t enc_sum_switchless(const unsigned char* buffer, size_t size)
+{
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < size; i++)
+        sum += buffer[i];
+
+    return sum;
+}
+
 int enc_echo_regular(
     const char* in,
     char* out,
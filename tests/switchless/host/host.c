@@ -62,6 +62,21 @@ int host_echo_switchless(
     return 0;
 }
 
+uint64_t host_sum_switchless(const unsigned char* buffer, size_t size)
+{
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < size; i++)
+        sum += buffer[i];
+
+    return sum;
+}
+
+uint64_t host_increment_switchless(uint64_t value)
+{
+    return value + 1;
+}
+
 int host_echo_regular(
     const char* in,
     char* out,
@@ -374,6 +389,85 @@ void test_switchless_ecalls(oe_enclave_t* enclave, uint64_t num_host_threads)
         (double)regular_microseconds / switchless_max);
 }
 
+// Switchless ECALLs run nested in the ECALL of an enclave worker. Growing
+// sizes make them need more than the marshaling buffer of the worker.
+void test_large_switchless_ecalls(oe_enclave_t* enclave)
+{
+    static unsigned char buffer[48 * 1024];
+    const size_t sizes[] = {1024, 8 * 1024, 16 * 1024, 48 * 1024};
+
+    for (size_t i = 0; i < sizeof(buffer); i++)
+        buffer[i] = (unsigned char)i;
+
+    for (size_t i = 0; i < OE_COUNTOF(sizes); i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            uint64_t expected = 0;
+            uint64_t sum = 0;
+
+            for (size_t k = 0; k < sizes[i]; k++)
+                expected += buffer[k];
+
+            OE_TEST(
+                enc_sum_switchless(enclave, &sum, buffer, sizes[i]) == OE_OK);
+            OE_TEST(sum == expected);
+        }
+    }
+}
+
+void test_switchless_statistics(oe_enclave_t* enclave, bool test_ecalls)
+{
+    oe_switchless_statistics_t statistics;
+    oe_switchless_worker_statistics_t worker_statistics;
+    const oe_switchless_worker_statistics_t* workers = NULL;
+    oe_switchless_worker_type_t type;
+    size_t num_workers;
+    uint64_t call_count = 0;
+
+    OE_TEST(oe_get_switchless_statistics(enclave, &statistics) == OE_OK);
+
+    if (test_ecalls)
+    {
+        type = OE_SWITCHLESS_ENCLAVE_WORKER;
+        workers = &statistics.enclave_workers;
+        num_workers = statistics.num_enclave_workers;
+    }
+    else
+    {
+        type = OE_SWITCHLESS_HOST_WORKER;
+        workers = &statistics.host_workers;
+        num_workers = statistics.num_host_workers;
+    }
+
+    printf(
+        "Switchless workers: %zu, calls: %" PRIu64 ", missed: %" PRIu64
+        ", wakes: %" PRIu64 "\n",
+        num_workers,
+        workers->call_count,
+        workers->missed_count,
+        workers->wake_count);
+
+    OE_TEST(num_workers > 0);
+    OE_TEST(workers->call_count > 0);
+    OE_TEST(workers->busy_time > 0);
+
+    // The calls are all complete, so the per-worker counts add up.
+    for (size_t i = 0; i < num_workers; i++)
+    {
+        OE_TEST(
+            oe_get_switchless_worker_statistics(
+                enclave, type, i, &worker_statistics) == OE_OK);
+        call_count += worker_statistics.call_count;
+    }
+    OE_TEST(call_count == workers->call_count);
+
+    OE_TEST(
+        oe_get_switchless_worker_statistics(
+            enclave, type, num_workers, &worker_statistics) ==
+        OE_OUT_OF_BOUNDS);
+}
+
 int main(int argc, const char* argv[])
 {
     oe_enclave_t* enclave = NULL;
@@ -385,7 +479,7 @@ int main(int argc, const char* argv[])
         fprintf(
             stderr,
             "Usage: %s ENCLAVE_PATH [--host-threads n] [--enclave-threads n] "
-            "[--ecalls]\n",
+            "[--ecalls] [--elastic] [--pinned] [--ecall-spin-budget usec]\n",
             argv[0]);
         return 1;
     }
@@ -393,6 +487,9 @@ int main(int argc, const char* argv[])
     uint64_t num_host_threads = 1;
     uint64_t num_enclave_threads = 2;
     bool test_ecalls = false;
+    bool elastic = false;
+    bool pinned = false;
+    uint64_t ecall_spin_budget = OE_SWITCHLESS_SPIN_FOREVER;
 
     {
         int i = 2;
@@ -414,6 +511,20 @@ int main(int argc, const char* argv[])
             {
                 test_ecalls = true;
             }
+            else if (strcmp(argv[i], "--elastic") == 0)
+            {
+                elastic = true;
+            }
+            else if (strcmp(argv[i], "--pinned") == 0)
+            {
+                pinned = true;
+            }
+            else if (strcmp(argv[i], "--ecall-spin-budget") == 0)
+            {
+                if (++i == argc)
+                    goto print_usage;
+                sscanf_s(argv[i], "%" SCNu64, &ecall_spin_budget);
+            }
             else
                 goto print_usage;
 
@@ -436,24 +547,84 @@ int main(int argc, const char* argv[])
     else
         switchless_setting.max_host_workers = num_host_threads;
 
+    // Or let the pools grow from a single worker up to the same maximum.
+    oe_enclave_setting_context_switchless_elastic_t elastic_setting = {
+        .min_host_workers = 1,
+        .max_host_workers = switchless_setting.max_host_workers,
+        .min_enclave_workers = 1,
+        .max_enclave_workers = switchless_setting.max_enclave_workers,
+        .target_utilization = 50,
+        .adjust_interval_msec = 1};
+
+    // Optionally run all the workers on the first CPU, with their contexts on
+    // the first NUMA node, which every machine has.
+    static const uint32_t worker_cpus[] = {0};
+    oe_enclave_setting_context_switchless_placement_t placement_setting = {
+        .host_worker_cpus = worker_cpus,
+        .host_worker_cpu_count = OE_COUNTOF(worker_cpus),
+        .enclave_worker_cpus = worker_cpus,
+        .enclave_worker_cpu_count = OE_COUNTOF(worker_cpus),
+        .host_worker_numa_node = 0,
+        .enclave_worker_numa_node = 0};
+
     oe_enclave_setting_t settings[] = {
         {.setting_type = OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS,
-         .u.context_switchless_setting = &switchless_setting}};
+         .u.context_switchless_setting = &switchless_setting},
+        {.setting_type = OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS_PLACEMENT,
+         .u.context_switchless_placement_setting = &placement_setting}};
+
+    if (elastic)
+    {
+        settings[0].setting_type =
+            OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS_ELASTIC;
+        settings[0].u.context_switchless_elastic_setting = &elastic_setting;
+    }
 
     if ((result = oe_create_switchless_test_enclave(
              argv[1],
              OE_ENCLAVE_TYPE_SGX,
              flags,
              settings,
-             OE_COUNTOF(settings),
+             pinned ? 2 : 1,
              &enclave)) != OE_OK)
         oe_put_err("oe_create_enclave(): result=%u", result);
 
+    if (ecall_spin_budget != OE_SWITCHLESS_SPIN_FOREVER)
+        OE_TEST(
+            oe_set_switchless_ecall_spin_budget(enclave, ecall_spin_budget) ==
+            OE_OK);
+
     if (test_ecalls)
+    {
+        int return_val = -1;
+
         test_switchless_ecalls(enclave, num_host_threads);
+        test_large_switchless_ecalls(enclave);
+
+        // No host workers run, so asynchronous ocalls fall back to regular
+        // ones.
+        OE_TEST(
+            enc_test_async_switchless(enclave, &return_val, false) == OE_OK);
+        OE_TEST(return_val == 0);
+    }
     else
+    {
+        int return_val = -1;
+
         test_switchless_ocalls(enclave, num_enclave_threads);
 
+        OE_TEST(enc_test_async_switchless(enclave, &return_val, true) == OE_OK);
+        OE_TEST(return_val == 0);
+
+        // Larger than the 1 MB first chunk of the shared memory arena
+        OE_TEST(
+            enc_test_large_switchless(
+                enclave, &return_val, 3 * 1024 * 1024, 4) == OE_OK);
+        OE_TEST(return_val == 0);
+    }
+
+    test_switchless_statistics(enclave, test_ecalls);
+
     result = oe_terminate_enclave(enclave);
     OE_TEST(result == OE_OK);
 
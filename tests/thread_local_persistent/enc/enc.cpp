@@ -0,0 +1,127 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/advanced/mallinfo.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+#include "persistent_t.h"
+
+static __thread uint64_t _counter;
+
+/* Heap memory owned by a thread-local, which the leak check at termination
+ * reports unless its destructor ran */
+static thread_local std::vector<uint64_t> _history;
+
+static pthread_once_t _once = PTHREAD_ONCE_INIT;
+static pthread_key_t _key;
+static uint64_t _destructed;
+
+static void _destructor(void* value)
+{
+    OE_UNUSED(value);
+    __atomic_add_fetch(&_destructed, 1, __ATOMIC_SEQ_CST);
+    OE_TEST(host_key_destructed() == OE_OK);
+}
+
+static void _create_key(void)
+{
+    OE_TEST(pthread_key_create(&_key, _destructor) == 0);
+}
+
+/* Increment the thread-local counter and its pthread_key copy, which must
+ * always agree */
+uint64_t enc_increment()
+{
+    OE_TEST(pthread_once(&_once, _create_key) == 0);
+
+    uintptr_t value = (uintptr_t)pthread_getspecific(_key);
+    OE_TEST(value == _counter);
+
+    _counter++;
+    OE_TEST(pthread_setspecific(_key, (void*)(uintptr_t)_counter) == 0);
+    _history.push_back(_counter);
+
+    return _counter;
+}
+
+/* Keep the TCS busy until the host lets the ECALL return */
+uint64_t enc_increment_and_wait()
+{
+    uint64_t value = enc_increment();
+    OE_TEST(host_wait() == OE_OK);
+    return value;
+}
+
+void enc_reset()
+{
+    OE_TEST(oe_reset_thread_locals() == OE_OK);
+
+    /* The values are kept until the ECALL returns */
+    OE_TEST(_counter != 0);
+}
+
+uint64_t enc_get_destructed()
+{
+    return __atomic_load_n(&_destructed, __ATOMIC_SEQ_CST);
+}
+
+static pthread_once_t _heap_once = PTHREAD_ONCE_INIT;
+static size_t _allocated_heap_size;
+static size_t _cached_heap_size;
+
+static size_t _get_allocated_heap_size(void)
+{
+    oe_mallinfo_t info;
+    OE_TEST(oe_allocator_mallinfo(&info) == OE_OK);
+    return info.current_allocated_heap_size;
+}
+
+/* Runs after the thread-locals of every TCS are released at termination, so
+ * the allocator must have taken back the blocks each TCS kept cached */
+static void _check_cached_blocks_released(void)
+{
+    OE_TEST(
+        _get_allocated_heap_size() + _cached_heap_size <=
+        _allocated_heap_size);
+}
+
+static void _register_heap_check(void)
+{
+    OE_TEST(atexit(_check_cached_blocks_released) == 0);
+}
+
+/* Allocate and free small blocks, which the allocator keeps cached for the
+ * TCS, and record how much heap they hold */
+void enc_allocate_and_free()
+{
+    void* blocks[20];
+
+    OE_TEST(pthread_once(&_heap_once, _register_heap_check) == 0);
+
+    size_t before = _get_allocated_heap_size();
+
+    for (size_t i = 0; i < OE_COUNTOF(blocks); i++)
+        OE_TEST((blocks[i] = malloc(600)) != NULL);
+    for (size_t i = 0; i < OE_COUNTOF(blocks); i++)
+        free(blocks[i]);
+
+    size_t after = _get_allocated_heap_size();
+    OE_TEST(after > before);
+
+    __atomic_add_fetch(&_cached_heap_size, after - before, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&_allocated_heap_size, after, __ATOMIC_SEQ_CST);
+}
+
+OE_SET_ENCLAVE_SGX_PERSISTENT_THREAD_LOCALS();
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* Debug */
+    1024, /* NumHeapPages */
+    16,   /* NumStackPages */
+    2);   /* NumTCS */
@@ -0,0 +1,121 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <future>
+#include <thread>
+#include "persistent_u.h"
+
+static std::atomic<uint64_t> _key_destructed;
+static std::promise<void> _entered;
+static std::promise<void> _released;
+
+void host_key_destructed()
+{
+    _key_destructed++;
+}
+
+void host_wait()
+{
+    _entered.set_value();
+    _released.get_future().wait();
+}
+
+static uint64_t _increment(oe_enclave_t* enclave)
+{
+    uint64_t value = 0;
+    OE_TEST(enc_increment(enclave, &value) == OE_OK);
+    return value;
+}
+
+static uint64_t _destructed(oe_enclave_t* enclave)
+{
+    uint64_t value = 0;
+    OE_TEST(enc_get_destructed(enclave, &value) == OE_OK);
+    return value;
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+    if ((result = oe_create_persistent_enclave(
+             argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    /* ECALLs made one at a time all use the first of the two TCSs */
+
+    // The values are kept across ECALLs of the same host thread.
+    OE_TEST(_increment(enclave) == 1);
+    OE_TEST(_increment(enclave) == 2);
+    OE_TEST(_increment(enclave) == 3);
+    OE_TEST(_destructed(enclave) == 0);
+
+    // They are destroyed when the ECALL that requested it returns.
+    OE_TEST(enc_reset(enclave) == OE_OK);
+    OE_TEST(_destructed(enclave) == 1);
+    OE_TEST(_increment(enclave) == 1);
+    OE_TEST(_increment(enclave) == 2);
+
+    // Another host thread does not see them.
+    std::thread thread([enclave]() {
+        OE_TEST(_increment(enclave) == 1);
+        OE_TEST(_destructed(enclave) == 2);
+        OE_TEST(_increment(enclave) == 2);
+    });
+    thread.join();
+
+    // Nor does a later thread, which the OS may give the handle of the thread
+    // that just exited.
+    std::thread next_thread([enclave]() {
+        OE_TEST(_increment(enclave) == 1);
+        OE_TEST(_destructed(enclave) == 3);
+    });
+    next_thread.join();
+
+    // Neither does this thread when it gets the TCS back.
+    OE_TEST(_increment(enclave) == 1);
+    OE_TEST(_destructed(enclave) == 4);
+
+    // Keep values on both TCSs: one thread waits in an ECALL on the first TCS
+    // while this thread makes an ECALL on the second.
+    // Both TCSs also keep small blocks cached by the allocator.
+    std::thread waiting_thread([enclave]() {
+        uint64_t value = 0;
+        OE_TEST(enc_allocate_and_free(enclave) == OE_OK);
+        OE_TEST(enc_increment_and_wait(enclave, &value) == OE_OK);
+        OE_TEST(value == 1);
+    });
+    _entered.get_future().wait();
+    OE_TEST(_increment(enclave) == 1);
+    OE_TEST(enc_allocate_and_free(enclave) == OE_OK);
+    _released.set_value();
+    waiting_thread.join();
+
+    // Terminating the enclave destroys the values of both TCSs and gives
+    // their cached blocks back to the allocator, before the enclave checks
+    // for memory leaks.
+    uint64_t destructed = _destructed(enclave);
+    OE_TEST(_key_destructed == destructed);
+
+    result = oe_terminate_enclave(enclave);
+    OE_TEST(result == OE_OK);
+    OE_TEST(_key_destructed == destructed + 2);
+
+    printf("=== passed all tests (thread_local_persistent)\n");
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <stdlib.h>
+#include <string.h>
+#include "transition_bench_t.h"
+
+/* Callers of the switchless benchmarks, plus the enclave workers */
+#define NUM_TCS 16
+
+void enc_empty(void)
+{
+}
+
+void enc_empty_switchless(void)
+{
+}
+
+void enc_in(const unsigned char* buffer, size_t size)
+{
+    OE_UNUSED(buffer);
+    OE_UNUSED(size);
+}
+
+void enc_out(unsigned char* buffer, size_t size)
+{
+    OE_UNUSED(buffer);
+    OE_UNUSED(size);
+}
+
+void enc_chained(int count)
+{
+    for (int i = count; i > 0; i--)
+        OE_TEST(host_chained(i - 1) == OE_OK);
+}
+
+void enc_call_host(int slot, size_t count, int kind, size_t size)
+{
+    unsigned char* buffer = NULL;
+
+    if (kind == OCALL_IN && size)
+    {
+        OE_TEST((buffer = (unsigned char*)malloc(size)) != NULL);
+        memset(buffer, 0, size);
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        switch (kind)
+        {
+            case OCALL_EMPTY:
+                OE_TEST(host_empty(slot) == OE_OK);
+                break;
+            case OCALL_EMPTY_SWITCHLESS:
+                OE_TEST(host_empty_switchless(slot) == OE_OK);
+                break;
+            case OCALL_IN:
+                OE_TEST(host_in(slot, buffer, size) == OE_OK);
+                break;
+            default:
+                OE_TEST(false);
+        }
+    }
+
+    free(buffer);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,        /* ProductID */
+    1,        /* SecurityVersion */
+    true,     /* Debug */
+    16384,    /* NumHeapPages */
+    128,      /* NumStackPages */
+    NUM_TCS); /* NumTCS */
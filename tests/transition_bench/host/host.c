@@ -0,0 +1,462 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/switchless.h>
+#include <openenclave/internal/tests.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../../host/hostthread.h"
+#include "transition_bench_u.h"
+
+/*
+**==============================================================================
+**
+** Benchmark of the enclave transitions
+**
+**     Measures the latency of each call and prints the percentiles of the
+**     latencies of every benchmark as a JSON document. Run it in simulation
+**     mode by setting OE_SIMULATION=1 in the environment.
+**
+**     The latency of an OCALL is measured on the host as the time between two
+**     consecutive OCALLs of the same enclave thread, which includes the loop
+**     in the enclave that makes them.
+**
+**==============================================================================
+*/
+
+#define DEFAULT_ITERATIONS 10000
+#define MAX_THREADS 4
+#define MAX_CHAINED_OCALLS 8
+
+typedef struct _slot
+{
+    uint64_t last;
+    uint64_t* samples;
+    size_t count;
+    size_t capacity;
+} slot_t;
+
+typedef struct _caller
+{
+    oe_enclave_t* enclave;
+    int slot;
+    size_t iterations;
+    uint64_t* samples;
+} caller_t;
+
+static slot_t _slots[MAX_THREADS];
+static FILE* _out;
+static bool _first_result = true;
+
+static uint64_t _now(void)
+{
+    return oe_switchless_get_time();
+}
+
+static void _record(int slot)
+{
+    slot_t* s = &_slots[slot];
+    uint64_t now = _now();
+
+    if (s->last && s->count < s->capacity)
+        s->samples[s->count++] = now - s->last;
+
+    s->last = now;
+}
+
+void host_empty(int slot)
+{
+    _record(slot);
+}
+
+void host_empty_switchless(int slot)
+{
+    _record(slot);
+}
+
+void host_in(int slot, const unsigned char* buffer, size_t size)
+{
+    OE_UNUSED(buffer);
+    OE_UNUSED(size);
+    _record(slot);
+}
+
+void host_chained(int remaining)
+{
+    OE_UNUSED(remaining);
+}
+
+static int _compare(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+static uint64_t _percentile(
+    const uint64_t* samples,
+    size_t count,
+    size_t permille)
+{
+    return samples[(count - 1) * permille / 1000];
+}
+
+static void _report(
+    const char* name,
+    size_t payload,
+    size_t threads,
+    size_t workers,
+    uint64_t* samples,
+    size_t count)
+{
+    uint64_t total = 0;
+
+    OE_TEST(count > 0);
+
+    qsort(samples, count, sizeof(uint64_t), _compare);
+
+    for (size_t i = 0; i < count; i++)
+        total += samples[i];
+
+    fprintf(
+        _out,
+        "%s\n    {\"name\": \"%s\", \"payload_bytes\": %zu, "
+        "\"threads\": %zu, \"workers\": %zu, \"samples\": %zu, "
+        "\"min_ns\": %llu, \"mean_ns\": %llu, \"p50_ns\": %llu, "
+        "\"p90_ns\": %llu, \"p99_ns\": %llu, \"p999_ns\": %llu, "
+        "\"max_ns\": %llu}",
+        _first_result ? "" : ",",
+        name,
+        payload,
+        threads,
+        workers,
+        count,
+        (unsigned long long)samples[0],
+        (unsigned long long)(total / count),
+        (unsigned long long)_percentile(samples, count, 500),
+        (unsigned long long)_percentile(samples, count, 900),
+        (unsigned long long)_percentile(samples, count, 990),
+        (unsigned long long)_percentile(samples, count, 999),
+        (unsigned long long)samples[count - 1]);
+    fflush(_out);
+
+    _first_result = false;
+}
+
+/* Large payloads are measured fewer times to bound the run time */
+static size_t _iterations_for_size(size_t iterations, size_t size)
+{
+    const size_t budget = 64 * 1024;
+    size_t n = 0;
+
+    if (size <= budget || iterations <= 10)
+        return iterations;
+
+    n = iterations * budget / size;
+    return n < 10 ? 10 : n;
+}
+
+static void _free_slots(void)
+{
+    for (size_t i = 0; i < MAX_THREADS; i++)
+    {
+        free(_slots[i].samples);
+        memset(&_slots[i], 0, sizeof(_slots[i]));
+    }
+}
+
+static void _reset_slots(size_t capacity)
+{
+    for (size_t i = 0; i < MAX_THREADS; i++)
+    {
+        free(_slots[i].samples);
+        _slots[i].samples = (uint64_t*)calloc(capacity, sizeof(uint64_t));
+        OE_TEST(_slots[i].samples != NULL);
+        _slots[i].last = 0;
+        _slots[i].count = 0;
+        _slots[i].capacity = capacity;
+    }
+}
+
+static void* _ecall_switchless_thread(void* arg)
+{
+    caller_t* caller = (caller_t*)arg;
+
+    for (size_t i = 0; i < caller->iterations; i++)
+    {
+        uint64_t start = _now();
+        OE_TEST(enc_empty_switchless(caller->enclave) == OE_OK);
+        caller->samples[i] = _now() - start;
+    }
+
+    return NULL;
+}
+
+static void* _ocall_switchless_thread(void* arg)
+{
+    caller_t* caller = (caller_t*)arg;
+
+    /* The first OCALL only starts the clock of the slot */
+    OE_TEST(
+        enc_call_host(
+            caller->enclave,
+            caller->slot,
+            caller->iterations + 1,
+            OCALL_EMPTY_SWITCHLESS,
+            0) == OE_OK);
+
+    return NULL;
+}
+
+static void _run_threads(
+    oe_enclave_t* enclave,
+    void* (*func)(void*),
+    size_t threads,
+    size_t iterations,
+    uint64_t* samples)
+{
+    oe_thread_t handles[MAX_THREADS];
+    caller_t callers[MAX_THREADS];
+
+    for (size_t i = 0; i < threads; i++)
+    {
+        callers[i].enclave = enclave;
+        callers[i].slot = (int)i;
+        callers[i].iterations = iterations;
+        callers[i].samples = samples + i * iterations;
+        OE_TEST(oe_thread_create(&handles[i], func, &callers[i]) == 0);
+    }
+
+    for (size_t i = 0; i < threads; i++)
+        oe_thread_join(handles[i]);
+}
+
+static void _bench_ecalls(oe_enclave_t* enclave, size_t iterations)
+{
+    uint64_t* samples = (uint64_t*)calloc(iterations, sizeof(uint64_t));
+    OE_TEST(samples != NULL);
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        uint64_t start = _now();
+        OE_TEST(enc_empty(enclave) == OE_OK);
+        samples[i] = _now() - start;
+    }
+
+    _report("ecall_empty", 0, 1, 0, samples, iterations);
+    free(samples);
+}
+
+static void _bench_ocalls(oe_enclave_t* enclave, size_t iterations)
+{
+    _reset_slots(iterations);
+    OE_TEST(
+        enc_call_host(enclave, 0, iterations + 1, OCALL_EMPTY, 0) == OE_OK);
+    _report("ocall_empty", 0, 1, 0, _slots[0].samples, _slots[0].count);
+}
+
+static void _bench_payloads(oe_enclave_t* enclave, size_t iterations)
+{
+    const size_t max_size = 4 * 1024 * 1024;
+    unsigned char* buffer = (unsigned char*)calloc(1, max_size);
+    uint64_t* samples = (uint64_t*)calloc(iterations, sizeof(uint64_t));
+
+    OE_TEST(buffer != NULL && samples != NULL);
+
+    for (size_t size = 0; size <= max_size; size = size ? size * 4 : 16)
+    {
+        size_t n = _iterations_for_size(iterations, size);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t start = _now();
+            OE_TEST(enc_in(enclave, buffer, size) == OE_OK);
+            samples[i] = _now() - start;
+        }
+        _report("ecall_in", size, 1, 0, samples, n);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t start = _now();
+            OE_TEST(enc_out(enclave, buffer, size) == OE_OK);
+            samples[i] = _now() - start;
+        }
+        _report("ecall_out", size, 1, 0, samples, n);
+
+        _reset_slots(n);
+        OE_TEST(enc_call_host(enclave, 0, n + 1, OCALL_IN, size) == OE_OK);
+        _report("ocall_in", size, 1, 0, _slots[0].samples, _slots[0].count);
+    }
+
+    free(samples);
+    free(buffer);
+}
+
+static void _bench_chained(oe_enclave_t* enclave, size_t iterations)
+{
+    char name[32];
+    uint64_t* samples = (uint64_t*)calloc(iterations, sizeof(uint64_t));
+    OE_TEST(samples != NULL);
+
+    // ECALLs cannot be made from OCALLs, so measure ECALLs that make a chain
+    // of OCALLs instead.
+    for (int count = 1; count <= MAX_CHAINED_OCALLS; count *= 2)
+    {
+        for (size_t i = 0; i < iterations; i++)
+        {
+            uint64_t start = _now();
+            OE_TEST(enc_chained(enclave, count) == OE_OK);
+            samples[i] = _now() - start;
+        }
+
+        snprintf(name, sizeof(name), "ecall_chained_ocalls_%d", count);
+        _report(name, 0, 1, 0, samples, iterations);
+    }
+
+    free(samples);
+}
+
+static void _bench_switchless(
+    const char* path,
+    uint32_t flags,
+    size_t iterations)
+{
+    uint64_t* samples =
+        (uint64_t*)calloc(MAX_THREADS * iterations, sizeof(uint64_t));
+    OE_TEST(samples != NULL);
+
+    for (uint32_t workers = 1; workers <= MAX_THREADS; workers *= 2)
+    {
+        oe_enclave_t* enclave = NULL;
+        oe_enclave_setting_context_switchless_t switchless_setting = {workers,
+                                                                      workers};
+        oe_enclave_setting_t setting;
+
+        setting.setting_type = OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS;
+        setting.u.context_switchless_setting = &switchless_setting;
+
+        OE_TEST(
+            oe_create_transition_bench_enclave(
+                path, OE_ENCLAVE_TYPE_SGX, flags, &setting, 1, &enclave) ==
+            OE_OK);
+
+        for (size_t threads = 1; threads <= MAX_THREADS; threads *= 2)
+        {
+            _run_threads(
+                enclave,
+                _ecall_switchless_thread,
+                threads,
+                iterations,
+                samples);
+            _report(
+                "ecall_switchless",
+                0,
+                threads,
+                workers,
+                samples,
+                threads * iterations);
+
+            _reset_slots(iterations);
+            _run_threads(
+                enclave, _ocall_switchless_thread, threads, iterations, NULL);
+
+            for (size_t i = 0; i < threads; i++)
+            {
+                memcpy(
+                    samples + i * iterations,
+                    _slots[i].samples,
+                    _slots[i].count * sizeof(uint64_t));
+                OE_TEST(_slots[i].count == iterations);
+            }
+            _report(
+                "ocall_switchless",
+                0,
+                threads,
+                workers,
+                samples,
+                threads * iterations);
+        }
+
+        OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+    }
+
+    free(samples);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_enclave_t* enclave = NULL;
+    size_t iterations = DEFAULT_ITERATIONS;
+    const char* output = NULL;
+    const uint32_t flags = oe_get_create_flags();
+
+    if (argc < 2)
+    {
+        fprintf(
+            stderr,
+            "Usage: %s ENCLAVE_PATH [--iterations N] [--output FILE]\n",
+            argv[0]);
+        return 1;
+    }
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else
+        {
+            fprintf(stderr, "%s: unknown option: %s\n", argv[0], argv[i]);
+            return 1;
+        }
+    }
+
+    if (iterations == 0)
+    {
+        fprintf(stderr, "%s: the iterations must be positive\n", argv[0]);
+        return 1;
+    }
+
+    _out = stdout;
+    if (output && !(_out = fopen(output, "w")))
+    {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], output);
+        return 1;
+    }
+
+    OE_TEST(
+        oe_create_transition_bench_enclave(
+            argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave) == OE_OK);
+
+    fprintf(
+        _out,
+        "{\n  \"simulation\": %s,\n  \"iterations\": %zu,\n  \"results\": [",
+        (flags & OE_ENCLAVE_FLAG_SIMULATE) ? "true" : "false",
+        iterations);
+
+    _bench_ecalls(enclave, iterations);
+    _bench_ocalls(enclave, iterations);
+    _bench_payloads(enclave, iterations);
+    _bench_chained(enclave, iterations);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    _bench_switchless(argv[1], flags, iterations);
+
+    fprintf(_out, "\n  ]\n}\n");
+
+    if (_out != stdout)
+        fclose(_out);
+
+    _free_slots();
+
+    fprintf(stderr, "=== passed all tests (transition_bench)\n");
+
+    return 0;
+}